@@ -8,7 +8,10 @@ BaseForEverything::BaseForEverything(StudentWorld* world, int imageID, int start
                                    Direction dir, double size, unsigned int depth)
     : GraphObject(imageID, startX, startY, dir, size, depth)
     , m_alive(true)
-    , m_world(world) {
+    , m_world(world)
+    , m_handle(NO_ACTOR)
+    , m_passTick(-1) {
+    m_timer.owner = this;
 }
 
 bool BaseForEverything::isAlive() const {
@@ -16,7 +19,17 @@ bool BaseForEverything::isAlive() const {
 }
 
 void BaseForEverything::setDead() {
+    if (!m_alive)
+        return;
     m_alive = false;
+    m_world->onActorDied(this);
+}
+
+void BaseForEverything::moveTo(int x, int y) {
+    int oldX = getX();
+    int oldY = getY();
+    GraphObject::moveTo(x, y);
+    m_world->onActorMoved(this, oldX, oldY, x, y);
 }
 
 StudentWorld* BaseForEverything::getWorld() const {
@@ -26,8 +39,43 @@ StudentWorld* BaseForEverything::getWorld() const {
 void BaseForEverything::annoy(int amount) {
 }
 
+void BaseForEverything::revive(int x, int y, Direction dir) {
+    m_alive = true;
+    m_handle = NO_ACTOR;
+    teleportTo(x, y);
+    setDirection(dir);
+}
+
+Pickup::Pickup(StudentWorld* world, int imageID, int startX, int startY)
+    : BaseForEverything(world, imageID, startX, startY, right, 1.0, 2)
+    , m_triggered(true)
+    , m_lifetimeTicks(0)
+    , m_expiryTick(-1) {
+}
+
+void Pickup::setLifetime(int ticks) {
+    m_lifetimeTicks = ticks;
+    m_expiryTick = -1;
+}
+
+void Pickup::countDownLifetime() {
+    int now = getWorld()->getTick();
+    if (m_expiryTick < 0)
+        m_expiryTick = now + m_lifetimeTicks - 1;
+    if (now >= m_expiryTick)
+        setDead();
+    else
+        getWorld()->sleepUntil(this, m_expiryTick);
+}
+
+bool Pickup::consumeTrigger() {
+    bool triggered = m_triggered;
+    m_triggered = false;
+    return triggered;
+}
+
 Barrel::Barrel(StudentWorld* world, int startX, int startY)
-    : BaseForEverything(world, TID_BARREL, startX, startY, right, 1.0, 2) {
+    : Pickup(world, TID_BARREL, startX, startY) {
     setVisible(false);
 }
 
@@ -35,66 +83,63 @@ void Barrel::doSomething() {
     if (!isAlive())
         return;
 
-    if (!isVisible()) {
+    if (consumeTrigger()) {
         double distance = getWorld()->distanceToTunnelman(getX(), getY());
-        if (distance <= 4.0) {
-            setVisible(true);
-            return;
+        if (!isVisible()) {
+            if (distance <= 4.0) {
+                setVisible(true);
+                rearm();
+                return;
+            }
         }
-    }
-    else {
-        double distance = getWorld()->distanceToTunnelman(getX(), getY());
-        if (distance <= 3.0) {
+        else if (distance <= 3.0) {
             setDead();
             getWorld()->playSound(SOUND_FOUND_OIL);
             getWorld()->increaseScore(1000);
             getWorld()->decrementBarrels();
+            return;
         }
     }
+    getWorld()->setAsleep(this, true);
 }
 Boulder::Boulder(StudentWorld* world, int startX, int startY)
     : BaseForEverything(world, TID_BOULDER, startX, startY, down, 1.0, 1),
-      state(State::stable), ticks(0) {
+      m_behaviour(behave()) {
     setVisible(true);
+    world->addBoulder(startX, startY);
 }
 
 void Boulder::doSomething() {
     if (!isAlive()) {
         return;
     }
-    bool earthBelow;
-    int xCoord = getX();
-    int yCoord = getY() - 1;
-    if (state == State::stable) {
-         earthBelow = false;
-        for (int x = xCoord; x < xCoord + 4; x++) {
-            if (getWorld()->isEarthAt(x, yCoord)) {
-                earthBelow = true;
-                break;
-            }
-        }
-        if (!earthBelow) {
-            state = State::waiting;
-            ticks = 30;
-        }
-    } else if (state == State::waiting) {
-        ticks--;
-        if (ticks <= 0) {
-            state = State::falling;
-            getWorld()->playSound(SOUND_FALLING_ROCK);
-        }
-    } else if (state == State::falling) {
+    m_behaviour.resume(this);
+}
+
+Behaviour Boulder::behave() {
+    while (getWorld()->earthInRect(getX(), getY() - 1, 4, 1) != 0) {
+        // nothing changes until Earth under us is dug away
+        getWorld()->sleepBoulder(this);
+        co_await untilWoken();
+    }
+
+    co_await ticks(this, 30);
+    getWorld()->playSound(SOUND_FALLING_ROCK);
+
+    for (;;) {
+        co_await ticks(this, 1);
         int newY = getY() - 1;
         if (newY < 0 || getWorld()->isBlocked(getX(), newY)) {
             setDead();
-            return;
-        }
-        for (auto actor : getWorld()->getActors()) {
-            if ((actor->getID() == TID_PLAYER || actor->isProtester()) &&
-                std::sqrt(std::pow(actor->getX() - getX(), 2) + std::pow(actor->getY() - newY, 2)) <= 3.0) {
-                actor->annoy(100);
-                }
-        }
+            getWorld()->removeBoulder(getX(), getY());
+            co_return;
+        }
+        getWorld()->queryRadius(getX(), newY, 3.0, StudentWorld::protesterTypes(), [](BaseForEverything* actor) {
+            actor->annoy(100);
+            return true;
+        });
+        getWorld()->removeBoulder(getX(), getY());
+        getWorld()->addBoulder(getX(), newY);
         moveTo(getX(), newY);
     }
 }
@@ -104,48 +149,57 @@ void RegularProtester::bribeWithGold() {
     getWorld()->increaseScore(25);
 
     m_leaveOilField = true;
-    m_restingTicks = 0;
+    setRestingTicks(0);
 }
 
 GoldNugget::GoldNugget(StudentWorld* world, int startX, int startY, bool visible, bool pickupByProtester, bool permanent)
-    : BaseForEverything(world, TID_GOLD, startX, startY, right, 1.0, 2)
+    : Pickup(world, TID_GOLD, startX, startY)
     , m_pickupByProtester(pickupByProtester)
-    , m_permanent(permanent)
-    , m_lifetimeTicks(permanent ? -1 : 100) {
+    , m_permanent(permanent) {
+    setLifetime(100);
+    setVisible(visible);
+}
+
+void GoldNugget::respawn(int startX, int startY, bool visible, bool pickupByProtester, bool permanent) {
+    revive(startX, startY, right);
+    m_pickupByProtester = pickupByProtester;
+    m_permanent = permanent;
+    setLifetime(100);
     setVisible(visible);
+    rearm();
 }
 
 void GoldNugget::doSomething() {
     if (!isAlive())
         return;
 
-    if (!isVisible() && getWorld()->distanceToTunnelman(getX(), getY()) <= 4.0) {
+    bool triggered = consumeTrigger();
+    if (triggered && !isVisible() && getWorld()->distanceToTunnelman(getX(), getY()) <= 4.0) {
         setVisible(true);
+        rearm();
         return;
     }
 
     if (m_pickupByProtester) {
-        for (auto actor : getWorld()->getActors()) {
-            if (actor->isProtester() && actor->isAlive()) {
-                double dist = sqrt(pow(actor->getX() - getX(), 2) + pow(actor->getY() - getY(), 2));
-                if (dist <= 3.0) {
-
-                    Protester* protester = static_cast<Protester*>(actor);
-                    protester->bribeWithGold();
-                    
-                    setDead();
-                    return;
-                }
-            }
+        Protester* protester = nullptr;
+        if (triggered) {
+            getWorld()->queryRadius(getX(), getY(), 3.0, StudentWorld::protesterTypes(), [&](BaseForEverything* actor) {
+                protester = static_cast<Protester*>(actor);
+                return false;
+            });
+        }
+        if (protester) {
+            protester->bribeWithGold();
+            setDead();
+            return;
         }
 
         if (!m_permanent) {
-            m_lifetimeTicks--;
-            if (m_lifetimeTicks <= 0)
-                setDead();
+            countDownLifetime();
+            return;
         }
     } else {
-        if (getWorld()->distanceToTunnelman(getX(), getY()) <= 3.0) {
+        if (triggered && getWorld()->distanceToTunnelman(getX(), getY()) <= 3.0) {
             setDead();
             getWorld()->playSound(SOUND_GOT_GOODIE);
             getWorld()->increaseScore(10);
@@ -153,19 +207,27 @@ void GoldNugget::doSomething() {
             return;
         }
     }
+    getWorld()->setAsleep(this, true);
 }
 
 SonarKit::SonarKit(StudentWorld* world, int startX, int startY, int level)
-    : BaseForEverything(world, TID_SONAR, startX, startY, right, 1.0, 2) {
+    : Pickup(world, TID_SONAR, startX, startY) {
     setVisible(true);
-    m_lifetimeTicks = std::max(100, 300 - 10 * level);
+    setLifetime(std::max(100, 300 - 10 * level));
+}
+
+void SonarKit::respawn(int startX, int startY, int level) {
+    revive(startX, startY, right);
+    setVisible(true);
+    setLifetime(std::max(100, 300 - 10 * level));
+    rearm();
 }
 
 void SonarKit::doSomething() {
     if (!isAlive())
         return;
 
-    if (getWorld()->distanceToTunnelman(getX(), getY()) <= 3.0) {
+    if (consumeTrigger() && getWorld()->distanceToTunnelman(getX(), getY()) <= 3.0) {
         setDead();
         getWorld()->playSound(SOUND_GOT_GOODIE);
         getWorld()->getTunnelman()->increaseSonarChargeCount(1);
@@ -173,9 +235,7 @@ void SonarKit::doSomething() {
         return;
     }
 
-    m_lifetimeTicks--;
-    if (m_lifetimeTicks <= 0)
-        setDead();
+    countDownLifetime();
 }
 Squirt::Squirt(StudentWorld* world, int startX, int startY, Direction dir)
     : BaseForEverything(world, TID_WATER_SPURT, startX, startY, dir, 1.0, 1),
@@ -183,6 +243,12 @@ Squirt::Squirt(StudentWorld* world, int startX, int startY, Direction dir)
     setVisible(true);
 }
 
+void Squirt::respawn(int startX, int startY, Direction dir) {
+    revive(startX, startY, dir);
+    m_travelDistance = 4;
+    setVisible(true);
+}
+
 void Squirt::doSomething() {
     if (!isAlive())
         return;
@@ -314,17 +380,7 @@ bool Tunnelman::pMove(int x, int y) {
 }
 
 void Tunnelman::rmvEarthTunnel() {
-    bool earthDigged = false;
-    for (int x = getX(); x < getX() + 4; ++x) {
-        for (int y = getY(); y < getY() + 4; ++y) {
-            if (x >= 0 && x < 64 && y >= 0 && y < 60) {
-                if (getWorld()->removeEarth(x, y)) {
-                    earthDigged = true;
-                }
-            }
-        }
-    }
-    if (earthDigged) {
+    if (getWorld()->digEarth(getX(), getY())) {
         getWorld()->playSound(SOUND_DIG);
     }
 }
@@ -352,7 +408,7 @@ bool Tunnelman::fireSquirt() {
         m_waterUnits--;
         return false;
     }
-    getWorld()->addActor(new Squirt(getWorld(), squirtX, squirtY, getDirection()));
+    getWorld()->spawnSquirt(squirtX, squirtY, getDirection());
     getWorld()->playSound(SOUND_PLAYER_SQUIRT);
     m_waterUnits--;
     return true;
@@ -369,7 +425,7 @@ bool Tunnelman::useSonar() {
 }
 
 void Tunnelman::dropGold() {
-    getWorld()->addActor(new GoldNugget(getWorld(), getX(), getY(), true, true, false));
+    getWorld()->spawnDroppedGold(getX(), getY());
 }
 
 
@@ -414,16 +470,23 @@ void Tunnelman::annoy(int amount) {
 }
 
 WaterPool::WaterPool(StudentWorld* world, int startX, int startY, int level)
-    : BaseForEverything(world, TID_WATER_POOL, startX, startY, right, 1.0, 2) {
+    : Pickup(world, TID_WATER_POOL, startX, startY) {
+    setVisible(true);
+    setLifetime(std::max(100, 300 - 10 * level));
+}
+
+void WaterPool::respawn(int startX, int startY, int level) {
+    revive(startX, startY, right);
     setVisible(true);
-    m_lifetimeTicks = std::max(100, 300 - 10 * level);
+    setLifetime(std::max(100, 300 - 10 * level));
+    rearm();
 }
 
 void WaterPool::doSomething() {
     if (!isAlive())
         return;
 
-    if (getWorld()->distanceToTunnelman(getX(), getY()) <= 3.0) {
+    if (consumeTrigger() && getWorld()->distanceToTunnelman(getX(), getY()) <= 3.0) {
         setDead();
         getWorld()->playSound(SOUND_GOT_GOODIE);
         getWorld()->getTunnelman()->increaseWaterUnits(5);
@@ -431,9 +494,7 @@ void WaterPool::doSomething() {
         return;
     }
 
-    m_lifetimeTicks--;
-    if (m_lifetimeTicks <= 0)
-        setDead();
+    countDownLifetime();
 }
 
 Protester::Protester(StudentWorld* world, int imageID, int hitPoints)
@@ -445,7 +506,46 @@ Protester::Protester(StudentWorld* world, int imageID, int hitPoints)
     , m_leaveOilField(false) {
     setVisible(true);
     int level = world->getLevel();
-    m_restingTicks = std::max(0, (int)(3 - level/4));
+    m_restEnd = world->nextUpdateTick(this) + std::max(0, (int)(3 - level/4));
+    m_stareEnd = 0;
+}
+
+void Protester::respawn(int hitPoints) {
+    revive(60, 60, left);
+    m_hitPoints = hitPoints;
+    m_numSquaresToMove = rand() % 53 + 8;
+    m_ticksSinceLastShout = 0;
+    m_ticksSinceLastTurn = 0;
+    m_leaveOilField = false;
+    m_path.clear();
+    setVisible(true);
+    int level = getWorld()->getLevel();
+    m_restEnd = getWorld()->nextUpdateTick(this) + std::max(0, (int)(3 - level/4));
+    m_stareEnd = 0;
+}
+
+int Protester::getRestingTicks() const {
+    return std::max(0, m_restEnd - getWorld()->nextUpdateTick(this));
+}
+
+void Protester::setRestingTicks(int ticks) {
+    int next = getWorld()->nextUpdateTick(this);
+    int stareLeft = std::max(0, m_stareEnd - std::max(m_restEnd, next));
+    m_restEnd = next + ticks;
+    m_stareEnd = stareLeft > 0 ? m_restEnd + stareLeft : 0;
+    getWorld()->sleepUntil(this, wakeTick());
+}
+
+void Protester::stareFor(int ticks) {
+    m_stareEnd = std::max(m_restEnd, getWorld()->nextUpdateTick(this)) + ticks;
+    getWorld()->sleepUntil(this, wakeTick());
+}
+
+bool Protester::sleepWhileIdle() {
+    if (wakeTick() <= getWorld()->getTick())
+        return false;
+    getWorld()->sleepUntil(this, wakeTick());
+    return true;
 }
 
 
@@ -453,10 +553,8 @@ void Protester::doSomething() {
     if (!isAlive())
         return;
 
-    if (m_restingTicks > 0) {
-        m_restingTicks--;
+    if (sleepWhileIdle())
         return;
-    }
 
     m_ticksSinceLastShout++;
     m_ticksSinceLastTurn++;
@@ -467,7 +565,7 @@ void Protester::doSomething() {
             return;
         }
         moveToExit();
-        m_restingTicks = std::max(0, (int)(3 - getWorld()->getLevel()/4));
+        setRestingTicks(std::max(0, (int)(3 - getWorld()->getLevel()/4)));
         return;
     }
 
@@ -475,7 +573,7 @@ void Protester::doSomething() {
         getWorld()->playSound(SOUND_PROTESTER_YELL);
         getWorld()->getTunnelman()->annoy(2);
         m_ticksSinceLastShout = 0;
-        m_restingTicks = std::max(0, (int)(3 - getWorld()->getLevel()/4));
+        setRestingTicks(std::max(0, (int)(3 - getWorld()->getLevel()/4)));
         return;
     }
 
@@ -486,11 +584,16 @@ void Protester::doSomething() {
             setDirection(dirToTunnelman);
             moveInCurrentDirection();
             m_numSquaresToMove = 0;
-            m_restingTicks = std::max(0, (int)(3 - getWorld()->getLevel()/4));
+            setRestingTicks(std::max(0, (int)(3 - getWorld()->getLevel()/4)));
             return;
         }
     }
 
+    wander();
+    setRestingTicks(std::max(0, (int)(3 - getWorld()->getLevel()/4)));
+}
+
+void Protester::wander() {
     m_numSquaresToMove--;
     if (m_numSquaresToMove <= 0) {
         setMoveDirection();
@@ -499,7 +602,6 @@ void Protester::doSomething() {
     }
 
     moveInCurrentDirection();
-    m_restingTicks = std::max(0, (int)(3 - getWorld()->getLevel()/4));
 }
 
 void Protester::annoy(int amount) {
@@ -511,7 +613,7 @@ void Protester::annoy(int amount) {
     if (m_hitPoints <= 0) {
         m_leaveOilField = true;
         getWorld()->playSound(SOUND_PROTESTER_GIVE_UP);
-        m_restingTicks = 0;
+        setRestingTicks(0);
 
         if (amount >= 100)
             getWorld()->increaseScore(500);
@@ -520,7 +622,7 @@ void Protester::annoy(int amount) {
     } else {
         getWorld()->playSound(SOUND_PROTESTER_ANNOYED);
         int level = getWorld()->getLevel();
-        m_restingTicks = std::max(50, 100 - level * 10);
+        setRestingTicks(std::max(50, 100 - level * 10));
     }
 }
 
@@ -530,7 +632,7 @@ void HardcoreProtester::bribeWithGold() {
     getWorld()->increaseScore(50);
 
     int level = getWorld()->getLevel();
-    m_stareTimer = std::max(50, 100 - level * 10);
+    stareFor(std::max(50, 100 - level * 10));
 }
 
 void Protester::moveToExit() {
@@ -545,7 +647,7 @@ void Protester::bribeWithGold() {
     getWorld()->increaseScore(25);
 
     int level = getWorld()->getLevel();
-    m_restingTicks = 0;
+    setRestingTicks(0);
 }
 
 bool Protester::canMoveInDirection(Direction dir) const {
@@ -557,9 +659,7 @@ bool Protester::canMoveInDirection(Direction dir) const {
         case left: nextX--; break;
         case right: nextX++; break;
     }
-    if (nextX < 0 || nextX > 60 || nextY < 0 || nextY > 60)
-        return false;
-    return !getWorld()->isBlocked(nextX, nextY);
+    return getWorld()->canStandAt(nextX, nextY);
 }
 
 bool Protester::inLineOfSight() const {
@@ -589,22 +689,23 @@ bool Protester::tryPerpendicularTurn() {
         return false;
 
     Direction currentDir = getDirection();
-    std::vector<Direction> validDirs;
+    Direction validDirs[2];
+    int numValid = 0;
 
     if (currentDir == left || currentDir == right) {
         if (canMoveInDirection(up))
-            validDirs.push_back(up);
+            validDirs[numValid++] = up;
         if (canMoveInDirection(down))
-            validDirs.push_back(down);
+            validDirs[numValid++] = down;
     } else {
         if (canMoveInDirection(left))
-            validDirs.push_back(left);
+            validDirs[numValid++] = left;
         if (canMoveInDirection(right))
-            validDirs.push_back(right);
+            validDirs[numValid++] = right;
     }
 
-    if (!validDirs.empty()) {
-        setDirection(validDirs[rand() % validDirs.size()]);
+    if (numValid > 0) {
+        setDirection(validDirs[rand() % numValid]);
         m_ticksSinceLastTurn = 0;
         return true;
     }
@@ -613,14 +714,15 @@ bool Protester::tryPerpendicularTurn() {
 }
 
 void Protester::setMoveDirection() {
-    std::vector<Direction> validDirs;
-    if (canMoveInDirection(up)) validDirs.push_back(up);
-    if (canMoveInDirection(down)) validDirs.push_back(down);
-    if (canMoveInDirection(left)) validDirs.push_back(left);
-    if (canMoveInDirection(right)) validDirs.push_back(right);
-
-    if (!validDirs.empty()) {
-        setDirection(validDirs[rand() % validDirs.size()]);
+    Direction validDirs[4];
+    int numValid = 0;
+    if (canMoveInDirection(up)) validDirs[numValid++] = up;
+    if (canMoveInDirection(down)) validDirs[numValid++] = down;
+    if (canMoveInDirection(left)) validDirs[numValid++] = left;
+    if (canMoveInDirection(right)) validDirs[numValid++] = right;
+
+    if (numValid > 0) {
+        setDirection(validDirs[rand() % numValid]);
         m_numSquaresToMove = rand() % 53 + 8;
     }
 }
@@ -645,24 +747,22 @@ void Protester::moveInCurrentDirection() {
 RegularProtester::RegularProtester(StudentWorld* world)
     : Protester(world, TID_PROTESTER, 5) {
 }
+void RegularProtester::respawn() {
+    Protester::respawn(5);
+}
 HardcoreProtester::HardcoreProtester(StudentWorld* world)
-    : Protester(world, TID_HARD_CORE_PROTESTER, 20)
-    , m_stareTimer(0) {
+    : Protester(world, TID_HARD_CORE_PROTESTER, 20) {
+}
+void HardcoreProtester::respawn() {
+    Protester::respawn(20);
 }
 
 void HardcoreProtester::doSomething() {
     if (!isAlive())
         return;
 
-    if (getRestingTicks() > 0) {
-        setRestingTicks(getRestingTicks() - 1);
+    if (sleepWhileIdle())
         return;
-    }
-
-    if (m_stareTimer > 0) {
-        m_stareTimer--;
-        return;
-    }
 
     if (isLeaving()) {
         if (getX() == 60 && getY() == 60) {
@@ -685,7 +785,7 @@ void HardcoreProtester::doSomething() {
 
     if (getWorld()->distanceToTunnelman(getX(), getY()) > 4.0) {
         int M = 16 + getWorld()->getLevel() * 2;
-        if (canReachTunnelman(M)) {
+        if (!getWorld()->isBeyondDetailRadius(getX(), getY()) && canReachTunnelman(M)) {
 Direction nextMove = getPathToTunnelman();
 
             setDirection(nextMove);
@@ -704,76 +804,29 @@ Direction nextMove = getPathToTunnelman();
         }
     }
 
-    setNumSquaresToMove(getNumSquaresToMove() - 1);
-    if (getNumSquaresToMove() <= 0) {
-        setMoveDirection();
-    } else if (tryPerpendicularTurn()) {
-        setNumSquaresToMove(rand() % 53 + 8);
-    }
-
-    moveInCurrentDirection();
+    wander();
 }
 
 
 bool HardcoreProtester::canReachTunnelman(int M) const {
-    int startX = getX();
-    int startY = getY();
     int tunnelmanX = getWorld()->getTunnelman()->getX();
     int tunnelmanY = getWorld()->getTunnelman()->getY();
 
-    if (sqrt(pow(startX - tunnelmanX, 2) + pow(startY - tunnelmanY, 2)) <= M) {
+    if (sqrt(pow(getX() - tunnelmanX, 2) + pow(getY() - tunnelmanY, 2)) <= M) {
         return true;
     }
 
-    int visited[64][60] = {0};
-    int queueX[64 * 60];
-    int queueY[64 * 60];
-    int queueSteps[64 * 60];
-    int front = 0, back = 0;
-
-    queueX[back] = startX;
-    queueY[back] = startY;
-    queueSteps[back] = 0;
-    back++;
-    visited[startX][startY] = 1;
+    int cached = cachedStepsTo(tunnelmanX, tunnelmanY);
+    if (cached >= 0)
+        return cached <= M;
 
-    while (front < back) {
-        int currentX = queueX[front];
-        int currentY = queueY[front];
-        int steps = queueSteps[front];
-        front++;
-
-        if (steps >= M) {
-            continue;
-        }
-
-        int directions[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
-        for (int i = 0; i < 4; i++) {
-            int newX = currentX + directions[i][0];
-            int newY = currentY + directions[i][1];
-
-            if (newX >= 0 && newX < 64 && newY >= 0 && newY < 60 &&
-                !visited[newX][newY] && !getWorld()->isBlocked(newX, newY)) {
-                if (newX == tunnelmanX && newY == tunnelmanY) {
-                    return true;
-                }
-                queueX[back] = newX;
-                queueY[back] = newY;
-                queueSteps[back] = steps + 1;
-                back++;
-                visited[newX][newY] = 1;
-                }
-        }
-    }
-
-    return false;
+    const DistanceField& field = getWorld()->getTunnelmanField();
+    if (!field.hasResult())
+        return false;
+    int steps = field.distanceAt(getX(), getY());
+    return steps != DistanceField::UNREACHABLE && steps <= M;
 }
 
-
-
-
-
-
 double Protester::distanceToTunnelman() const {
     int tunnelmanX = getWorld()->getTunnelman()->getX();
     int tunnelmanY = getWorld()->getTunnelman()->getY();
@@ -795,136 +848,64 @@ bool Protester::isTunnelmanInLineOfSight() const {
     if (getX() == tunnelmanX) {
         int yStart = std::min(getY(), tunnelmanY) + 1;
         int yEnd = std::max(getY(), tunnelmanY);
-        for (int y = yStart; y < yEnd; y++) {
-            if (getWorld()->isBlocked(getX(), y)) {
-                return false;
-            }
-        }
-        return true;
+        return getWorld()->isColumnSpanClear(getX(), yStart, yEnd);
     } else if (getY() == tunnelmanY) {
         int xStart = std::min(getX(), tunnelmanX) + 1;
         int xEnd = std::max(getX(), tunnelmanX);
-        for (int x = xStart; x < xEnd; x++) {
-            if (getWorld()->isBlocked(x, getY())) {
-                return false;
-            }
-        }
-        return true;
+        return getWorld()->isRowSpanClear(getY(), xStart, xEnd);
     }
     return false;
 }
 
 GraphObject::Direction Protester::getPathToExit() {
-    int maze[64][60];
-    int qX[3840], qY[3840];
-    int qFront = 0, qBack = 0;
-
-    for (int i = 0; i < 64; i++)
-        for (int j = 0; j < 60; j++)
-            maze[i][j] = -1;
-
-    qX[qBack] = 60;
-    qY[qBack] = 60;
-    qBack++;
-    maze[60][60] = 0;
-
-    while (qFront < qBack) {
-        int x = qX[qFront];
-        int y = qY[qFront];
-        qFront++;
-
-        if (x == getX() && y == getY()) {
-            int minDist = maze[x][y];
-            if (x > 0 && maze[x-1][y] == minDist - 1) return left;
-            if (x < 63 && maze[x+1][y] == minDist - 1) return right;
-            if (y > 0 && maze[x][y-1] == minDist - 1) return down;
-            if (y < 59 && maze[x][y+1] == minDist - 1) return up;
-            return left;
-        }
-
-        if (x > 0 && maze[x-1][y] == -1 && !getWorld()->isBlocked(x-1, y)) {
-            maze[x-1][y] = maze[x][y] + 1;
-            qX[qBack] = x-1;
-            qY[qBack] = y;
-            qBack++;
-        }
-        if (x < 63 && maze[x+1][y] == -1 && !getWorld()->isBlocked(x+1, y)) {
-            maze[x+1][y] = maze[x][y] + 1;
-            qX[qBack] = x+1;
-            qY[qBack] = y;
-            qBack++;
-        }
-        if (y > 0 && maze[x][y-1] == -1 && !getWorld()->isBlocked(x, y-1)) {
-            maze[x][y-1] = maze[x][y] + 1;
-            qX[qBack] = x;
-            qY[qBack] = y-1;
-            qBack++;
-        }
-        if (y < 59 && maze[x][y+1] == -1 && !getWorld()->isBlocked(x, y+1)) {
-            maze[x][y+1] = maze[x][y] + 1;
-            qX[qBack] = x;
-            qY[qBack] = y+1;
-            qBack++;
-        }
+    return followPath(60, 60, &StudentWorld::getExitField);
+}
+
+int Protester::cachedStepsTo(int rootX, int rootY) const {
+    if (!getWorld()->isPathCaching() ||
+        !getWorld()->isTerrainUnchangedSince(m_path.getRegions(), m_path.getVersion()))
+        return -1;
+    return m_path.stepsLeft(getX(), getY(), rootX, rootY);
+}
+
+// The next step towards (rootX, rootY) down the field getField returns,
+// replayed from m_path while the route there still holds.
+GraphObject::Direction Protester::followPath(int rootX, int rootY, const DistanceField& (StudentWorld::*getField)()) {
+    StudentWorld* world = getWorld();
+    if (!world->isPathCaching())
+        return directionDownhill((world->*getField)());
+
+    Direction dir;
+    if (!m_path.nextStep(getX(), getY(), rootX, rootY, dir) ||
+        !world->isTerrainUnchangedSince(m_path.getRegions(), m_path.getVersion())) {
+        const DistanceField& field = (world->*getField)();
+        // only a field that matches the terrain as it is now is worth keeping
+        if (!field.isSettled() || field.hasChanges() || !field.isRootedAt(rootX, rootY))
+            return directionDownhill(field);
+        m_path.record(field, getX(), getY(), world->getTerrainVersion());
+        if (!m_path.nextStep(getX(), getY(), rootX, rootY, dir))
+            return directionDownhill(field);
+    }
+    m_path.advance();
+    return dir;
+}
+
+GraphObject::Direction Protester::directionDownhill(const DistanceField& field) const {
+    // no path yet: keep going the way we were
+    if (!field.hasResult())
+        return getDirection();
+    int x = getX();
+    int y = getY();
+    int dist = field.distanceAt(x, y);
+    if (dist > 0) {
+        if (field.distanceAt(x - 1, y) == dist - 1) return left;
+        if (field.distanceAt(x + 1, y) == dist - 1) return right;
+        if (field.distanceAt(x, y - 1) == dist - 1) return down;
+        if (field.distanceAt(x, y + 1) == dist - 1) return up;
     }
     return left;
 }
 
 GraphObject::Direction Protester::getPathToTunnelman() {
-    int maze[64][60];
-    int qX[3840], qY[3840];
-    int qFront = 0, qBack = 0;
-    int tunnelmanX = getWorld()->getTunnelman()->getX();
-    int tunnelmanY = getWorld()->getTunnelman()->getY();
-
-    for (int i = 0; i < 64; i++)
-        for (int j = 0; j < 60; j++)
-            maze[i][j] = -1;
-
-    qX[qBack] = tunnelmanX;
-    qY[qBack] = tunnelmanY;
-    qBack++;
-    maze[tunnelmanX][tunnelmanY] = 0;
-
-    while (qFront < qBack) {
-        int x = qX[qFront];
-        int y = qY[qFront];
-        qFront++;
-
-        if (x == getX() && y == getY()) {
-            int minDist = maze[x][y];
-            if (x > 0 && maze[x-1][y] == minDist - 1) return left;
-            if (x < 63 && maze[x+1][y] == minDist - 1) return right;
-            if (y > 0 && maze[x][y-1] == minDist - 1) return down;
-            if (y < 59 && maze[x][y+1] == minDist - 1) return up;
-            return left;
-        }
-
-        if (x > 0 && maze[x-1][y] == -1 && !getWorld()->isBlocked(x-1, y)) {
-            maze[x-1][y] = maze[x][y] + 1;
-            qX[qBack] = x-1;
-            qY[qBack] = y;
-            qBack++;
-        }
-        if (x < 63 && maze[x+1][y] == -1 && !getWorld()->isBlocked(x+1, y)) {
-            maze[x+1][y] = maze[x][y] + 1;
-            qX[qBack] = x+1;
-            qY[qBack] = y;
-            qBack++;
-        }
-        if (y > 0 && maze[x][y-1] == -1 && !getWorld()->isBlocked(x, y-1)) {
-            maze[x][y-1] = maze[x][y] + 1;
-            qX[qBack] = x;
-            qY[qBack] = y-1;
-            qBack++;
-        }
-        if (y < 59 && maze[x][y+1] == -1 && !getWorld()->isBlocked(x, y+1)) {
-            maze[x][y+1] = maze[x][y] + 1;
-            qX[qBack] = x;
-            qY[qBack] = y+1;
-            qBack++;
-        }
-    }
-    return left;
+    return followPath(getWorld()->getTunnelman()->getX(), getWorld()->getTunnelman()->getY(), &StudentWorld::getTunnelmanField);
 }
-
@@ -2,7 +2,9 @@
 #define ACTOR_H_
 #include "StudentWorld.h"
 
+#include "Coroutine.h"
 #include "GraphObject.h"
+#include "PathCache.h"
 class StudentWorld;
 
 class BaseForEverything : public GraphObject {
@@ -13,19 +15,57 @@ public:
     virtual void doSomething() = 0;
     bool isAlive() const;
     void setDead();
+    void moveTo(int x, int y);
 
     StudentWorld* getWorld() const;
+    ActorHandle getHandle() const { return m_handle; }
+    void setHandle(ActorHandle handle) { m_handle = handle; }
+    TimerNode<BaseForEverything>& getTimer() { return m_timer; }
+    // the tick whose by-type update pass last reached this actor
+    int getPassTick() const { return m_passTick; }
+    void setPassTick(int tick) { m_passTick = tick; }
     virtual bool isProtester() const { return false; }
     virtual void annoy(int amount);
 
+protected:
+    void revive(int x, int y, Direction dir);
+
 private:
     bool m_alive;
     StudentWorld* m_world;
+    ActorHandle m_handle;
+    int m_passTick;
+    TimerNode<BaseForEverything> m_timer;
 };
 
 
 
-class Barrel : public BaseForEverything {
+// Items that react to something coming near. Instead of measuring the
+// distance every tick, a pickup waits to be triggered by StudentWorld when
+// the Tunnelman (or, for gold, a protester) moves close to it.
+class Pickup : public BaseForEverything {
+public:
+    Pickup(StudentWorld* world, int imageID, int startX, int startY);
+    void trigger() { m_triggered = true; }
+
+protected:
+    // true once after each trigger (and once after spawning)
+    bool consumeTrigger();
+    void rearm() { m_triggered = true; }
+    // The pickup disappears on its ticks-th update, counting from the first
+    // update after this call.
+    void setLifetime(int ticks);
+    // Dies if this is the pickup's last update; otherwise sleeps until then
+    // (triggers still wake it early).
+    void countDownLifetime();
+
+private:
+    bool m_triggered;
+    int m_lifetimeTicks;
+    int m_expiryTick;
+};
+
+class Barrel : public Pickup {
 public:
     Barrel(StudentWorld* world, int startX, int startY);
     virtual void doSomething() override;
@@ -39,35 +79,21 @@ public:
     virtual void doSomething() override;
 
 private:
-    enum class State { stable, waiting, falling };
-    State state;
-    int ticks;
-};
-class Earth : public BaseForEverything {
-public:
-    Earth(StudentWorld* world, int startX, int startY)
-        : BaseForEverything(world, TID_EARTH, startX, startY, right, 0.25, 3) {
-        setVisible(true);
+    Behaviour behave();
 
-    }
-
-    virtual ~Earth() = default;
-
-    virtual void doSomething() override {
-    }
+    Behaviour m_behaviour;
 };
-
-class SonarKit : public BaseForEverything {
+class SonarKit : public Pickup {
 public:
     SonarKit(StudentWorld* world, int startX, int startY, int level);
+    void respawn(int startX, int startY, int level);
     virtual void doSomething() override;
-private:
-    int m_lifetimeTicks;
 };
 
 class Squirt : public BaseForEverything {
 public:
     Squirt(StudentWorld* world, int startX, int startY, Direction dir);
+    void respawn(int startX, int startY, Direction dir);
     virtual void doSomething() override;
 
 private:
@@ -103,24 +129,23 @@ private:
     void dropGold();
 };
 
-class GoldNugget : public BaseForEverything {
+class GoldNugget : public Pickup {
 public:
     GoldNugget(StudentWorld* world, int startX, int startY, bool visible, bool pickupByProtester, bool permanent);
+    void respawn(int startX, int startY, bool visible, bool pickupByProtester, bool permanent);
     virtual void doSomething() override;
 
 private:
     bool m_pickupByProtester;
     bool m_permanent;
-    int m_lifetimeTicks;
 };
 
 
-class WaterPool : public BaseForEverything {
+class WaterPool : public Pickup {
 public:
     WaterPool(StudentWorld* world, int startX, int startY, int level);
+    void respawn(int startX, int startY, int level);
     virtual void doSomething() override;
-private:
-    int m_lifetimeTicks;
 };
 
 class Protester : public BaseForEverything {
@@ -129,44 +154,64 @@ protected:
     int m_numSquaresToMove;
     int m_ticksSinceLastShout;
     int m_ticksSinceLastTurn;
-    int m_restingTicks;
     bool m_leaveOilField;
 
     double distanceToTunnelman() const;
     bool isTunnelmanInLineOfSight() const;
     Direction getPathToExit();
+    Direction directionDownhill(const DistanceField& field) const;
+    Direction followPath(int rootX, int rootY, const DistanceField& (StudentWorld::*getField)());
+    // steps left to (rootX, rootY) on the cached route, or -1 if unknown
+    int cachedStepsTo(int rootX, int rootY) const;
     bool canMoveInDirection(Direction dir) const;
     bool inLineOfSight() const;
     bool facingTunnelman() const;
     bool tryPerpendicularTurn();
     void setMoveDirection();
     void moveInCurrentDirection();
+    // the random walk a protester falls back on when it has no better move
+    void wander();
     virtual void moveToExit();
     Direction directionToMove() const;
     Direction getDirectionToTunnelman() const;
     Direction getPathToTunnelman();
-
+    // Holds the protester still for ticks updates once any rest is over.
+    void stareFor(int ticks);
+    // Puts the protester to sleep until its rest and stare are over; false if
+    // it is free to act this tick.
+    bool sleepWhileIdle();
 
 public:
     Protester(StudentWorld* world, int imageID, int hitPoints);
+    void respawn(int hitPoints);
     virtual void doSomething();
     virtual void annoy(int amount);
     virtual void bribeWithGold();
     bool isLeaving() const { return m_leaveOilField; }
     int getTicksSinceLastShout() const { return m_ticksSinceLastShout; }
     int getTicksSinceLastTurn() const { return m_ticksSinceLastTurn; }
-    int getRestingTicks() const { return m_restingTicks; }
+    int getRestingTicks() const;
     int getNumSquaresToMove() const { return m_numSquaresToMove; }
     void setTicksSinceLastShout(int ticks) { m_ticksSinceLastShout = ticks; }
     void setTicksSinceLastTurn(int ticks) { m_ticksSinceLastTurn = ticks; }
-    void setRestingTicks(int ticks) { m_restingTicks = ticks; }
+    void setRestingTicks(int ticks);
     void setNumSquaresToMove(int squares) { m_numSquaresToMove = squares; }
     virtual bool isProtester() const { return true; }
+
+private:
+    int wakeTick() const { return std::max(m_restEnd, m_stareEnd); }
+
+    // ticks of the first update after the rest and after the stare; the
+    // stare only starts counting once the rest is over
+    int m_restEnd;
+    int m_stareEnd;
+    PathCache m_path;
 };
 
 class RegularProtester : public Protester {
 public:
     RegularProtester(StudentWorld* world);
+    void respawn();
     virtual void bribeWithGold() override;
 
 };
@@ -174,13 +219,13 @@ public:
 class HardcoreProtester : public Protester {
 public:
     HardcoreProtester(StudentWorld* world);
+    void respawn();
 
     virtual void doSomething() override;
     virtual void bribeWithGold() override;
 
 private:
     bool canReachTunnelman(int M) const;
-    int m_stareTimer;
 };
 
 
@@ -0,0 +1,77 @@
+#ifndef ACTORPOOL_H_
+#define ACTORPOOL_H_
+
+#include <new>
+#include <utility>
+
+// Fixed-capacity storage for one kind of short-lived actor. A slot's object
+// is constructed the first time the slot is handed out and is reused through
+// T::respawn() after that instead of being deleted and allocated again. A
+// free slot's object is kept hidden.
+template <typename T, int N>
+class ActorPool {
+public:
+    ActorPool()
+        : m_numFree(N) {
+        for (int i = 0; i < N; ++i) {
+            m_constructed[i] = false;
+            m_free[i] = N - 1 - i;
+        }
+    }
+
+    ~ActorPool() {
+        for (int i = 0; i < N; ++i) {
+            if (m_constructed[i])
+                slot(i)->~T();
+        }
+    }
+
+    // Constructs every slot up front, hidden, so that later acquire() calls
+    // only ever reuse objects.
+    template <typename World, typename... Args>
+    void prewarm(World* world, const Args&... args) {
+        for (int i = 0; i < N; ++i) {
+            if (!m_constructed[i]) {
+                new (m_storage[i]) T(world, args...);
+                m_constructed[i] = true;
+                slot(i)->setVisible(false);
+            }
+        }
+    }
+
+    // Returns nullptr if every slot is in use.
+    template <typename World, typename... Args>
+    T* acquire(World* world, Args&&... args) {
+        if (m_numFree == 0)
+            return nullptr;
+        int i = m_free[--m_numFree];
+        if (!m_constructed[i]) {
+            new (m_storage[i]) T(world, std::forward<Args>(args)...);
+            m_constructed[i] = true;
+        } else {
+            slot(i)->respawn(std::forward<Args>(args)...);
+        }
+        return slot(i);
+    }
+
+    bool owns(const void* object) const {
+        const unsigned char* p = static_cast<const unsigned char*>(object);
+        return p >= m_storage[0] && p < m_storage[0] + sizeof(m_storage);
+    }
+
+    void release(T* object) {
+        object->setVisible(false);
+        unsigned char* p = reinterpret_cast<unsigned char*>(object);
+        m_free[m_numFree++] = static_cast<int>((p - m_storage[0]) / sizeof(T));
+    }
+
+private:
+    T* slot(int i) { return reinterpret_cast<T*>(m_storage[i]); }
+
+    alignas(T) unsigned char m_storage[N][sizeof(T)];
+    bool m_constructed[N];
+    int m_free[N];
+    int m_numFree;
+};
+
+#endif // ACTORPOOL_H_
@@ -0,0 +1,124 @@
+#include "AllocationCounter.h"
+
+#ifdef TUNNELMAN_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace {
+    std::atomic<std::size_t> numAllocations(0);
+
+    void* countedAllocate(std::size_t size) {
+        numAllocations++;
+        void* p = std::malloc(size == 0 ? 1 : size);
+        if (p == nullptr)
+            throw std::bad_alloc();
+        return p;
+    }
+
+    void* alignedAllocate(std::size_t size, std::align_val_t alignment) noexcept {
+        std::size_t align = static_cast<std::size_t>(alignment);
+        if (size == 0)
+            size = 1;
+#ifdef _MSC_VER
+        return _aligned_malloc(size, align);
+#else
+        // aligned_alloc wants a size that is a multiple of the alignment
+        return std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+    }
+
+    void* countedAlignedAllocate(std::size_t size, std::align_val_t alignment) {
+        numAllocations++;
+        void* p = alignedAllocate(size, alignment);
+        if (p == nullptr)
+            throw std::bad_alloc();
+        return p;
+    }
+
+    void alignedFree(void* p) noexcept {
+#ifdef _MSC_VER
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+}
+
+std::size_t allocationCount() {
+    return numAllocations;
+}
+
+void* operator new(std::size_t size) {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAllocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    numAllocations++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    numAllocations++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return countedAlignedAllocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return countedAlignedAllocate(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    numAllocations++;
+    return alignedAllocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    numAllocations++;
+    return alignedAllocate(size, alignment);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    alignedFree(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    alignedFree(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    alignedFree(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    alignedFree(p);
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef ALLOCATIONCOUNTER_H_
+#define ALLOCATIONCOUNTER_H_
+
+#include <cstddef>
+
+// Building with TUNNELMAN_COUNT_ALLOCATIONS defined replaces the global
+// operator new with one that counts calls, so tests and debug builds can
+// check that code which should not allocate really doesn't. Without the
+// flag, NoAllocationScope does nothing.
+
+#ifdef TUNNELMAN_COUNT_ALLOCATIONS
+
+#include <cassert>
+
+std::size_t allocationCount();
+
+// Asserts on destruction that nothing was allocated while it was alive.
+class NoAllocationScope {
+public:
+    NoAllocationScope() : m_start(allocationCount()) {}
+    ~NoAllocationScope() { assert(allocationCount() == m_start && "allocated inside a NoAllocationScope"); }
+
+private:
+    NoAllocationScope(const NoAllocationScope&);
+    NoAllocationScope& operator=(const NoAllocationScope&);
+
+    std::size_t m_start;
+};
+
+#else
+
+class NoAllocationScope {
+public:
+    NoAllocationScope() {}
+};
+
+#endif
+
+#endif // ALLOCATIONCOUNTER_H_
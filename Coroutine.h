@@ -0,0 +1,115 @@
+#ifndef COROUTINE_H_
+#define COROUTINE_H_
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+// An actor behaviour written as a coroutine. It runs from the actor's
+// doSomething() up to its next co_await, which puts the actor to sleep until
+// the awaited condition holds; the world only updates actors that are
+// awake, so a waiting behaviour costs nothing per tick.
+//
+// Frames come from the world's level arena, so a behaviour must be a member
+// function of an actor (the actor is what the frame is allocated through)
+// and must not outlive the level.
+class Behaviour {
+public:
+    struct promise_type {
+        template <typename Actor>
+        static void* operator new(std::size_t size, Actor& actor) {
+            return actor.getWorld()->allocateFrame(size);
+        }
+        static void operator delete(void*, std::size_t) {}
+
+        Behaviour get_return_object() { return Behaviour(Handle::from_promise(*this)); }
+        // the first resume() runs the body, not the constructor
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+
+        // the behaviour is not resumed before this tick
+        int resumeTick = 0;
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Behaviour()
+        : m_handle(nullptr) {}
+    Behaviour(Behaviour&& other) noexcept
+        : m_handle(other.m_handle) {
+        other.m_handle = nullptr;
+    }
+    Behaviour& operator=(Behaviour&& other) noexcept {
+        if (this != &other) {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+        return *this;
+    }
+    ~Behaviour() {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    bool done() const { return !m_handle || m_handle.done(); }
+
+    // Runs the behaviour to its next co_await. If actor was woken before
+    // the tick the behaviour is waiting for, it goes back to sleep instead.
+    template <typename Actor>
+    void resume(Actor* actor) {
+        if (done())
+            return;
+        int resumeTick = m_handle.promise().resumeTick;
+        if (actor->getWorld()->getTick() < resumeTick)
+            actor->getWorld()->sleepUntil(actor, resumeTick);
+        else
+            m_handle.resume();
+    }
+
+private:
+    explicit Behaviour(Handle handle)
+        : m_handle(handle) {}
+
+    Behaviour(const Behaviour&);
+    Behaviour& operator=(const Behaviour&);
+
+    Handle m_handle;
+};
+
+// co_await ticks(this, n) resumes on the actor's update n ticks from now.
+template <typename Actor>
+struct TicksAwaiter {
+    bool await_ready() const { return ticks <= 0; }
+    void await_suspend(Behaviour::Handle handle) {
+        int tick = actor->getWorld()->getTick() + ticks;
+        handle.promise().resumeTick = tick;
+        actor->getWorld()->sleepUntil(actor, tick);
+    }
+    void await_resume() {}
+
+    Actor* actor;
+    int ticks;
+};
+
+template <typename Actor>
+TicksAwaiter<Actor> ticks(Actor* actor, int n) {
+    return { actor, n };
+}
+
+// co_await untilWoken() resumes on the actor's next update, which for an
+// actor that has been put to sleep is whenever something wakes it. The
+// caller checks its condition again afterwards.
+struct WokenAwaiter {
+    bool await_ready() const { return false; }
+    void await_suspend(Behaviour::Handle handle) { handle.promise().resumeTick = 0; }
+    void await_resume() {}
+};
+
+inline WokenAwaiter untilWoken() {
+    return {};
+}
+
+#endif // COROUTINE_H_
@@ -0,0 +1,261 @@
+#include "DistanceField.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace {
+    const int directions[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+}
+
+DistanceField::DistanceField()
+    : m_resultRootX(-1), m_resultRootY(-1), m_hasChanges(false), m_phase(SETTLED), m_rootX(-1), m_rootY(-1) {
+    invalidate();
+}
+
+void DistanceField::invalidate() {
+    resetWorking();
+    std::memcpy(m_result, m_dist, sizeof(m_result));
+    m_resultRootX = -1;
+    m_resultRootY = -1;
+}
+
+// Clears the working distances and any pending run, leaving the settled
+// result alone.
+void DistanceField::resetWorking() {
+    for (int x = 0; x < SIZE; ++x) {
+        for (int y = 0; y < SIZE; ++y) {
+            m_dist[x][y] = INFINITE;
+            m_queued[x][y] = false;
+        }
+    }
+    for (int y = 0; y < SIZE; ++y)
+        m_changed[y] = 0;
+    m_hasChanges = false;
+    m_phase = SETTLED;
+    m_rootX = -1;
+    m_rootY = -1;
+}
+
+void DistanceField::compute(const std::uint64_t* openRows, int rootX, int rootY) {
+    beginCompute(rootX, rootY);
+    advance(openRows, INT_MAX);
+}
+
+void DistanceField::repair(const std::uint64_t* openRows) {
+    beginRepair(openRows);
+    advance(openRows, INT_MAX);
+}
+
+void DistanceField::beginCompute(int rootX, int rootY) {
+    resetWorking();
+    m_rootX = rootX;
+    m_rootY = rootY;
+    if (rootX < 0 || rootX >= SIZE || rootY < 0 || rootY >= SIZE) {
+        settle();
+        return;
+    }
+
+    m_dist[rootX][rootY] = 0;
+    m_seeds[0] = rootX * SIZE + rootY;
+    beginPropagate(1);
+}
+
+void DistanceField::markChanged(int y, std::uint64_t cells) {
+    if (y < 0 || y >= SIZE || cells == 0)
+        return;
+    m_changed[y] |= cells;
+    m_hasChanges = true;
+}
+
+int DistanceField::beginRepair(const std::uint64_t* openRows) {
+    if (!m_hasChanges)
+        return 0;
+    if (m_rootX < 0) {
+        invalidate();
+        return 0;
+    }
+
+    // changes reported from here on are left for the next repair
+    for (int y = 0; y < SIZE; ++y) {
+        m_repairing[y] = m_changed[y];
+        m_changed[y] = 0;
+    }
+    m_hasChanges = false;
+
+    // Positions that stopped being walkable lose their distance outright;
+    // everything whose shortest path ran through them is found by advance().
+    m_head = 0;
+    m_count = 0;
+    for (int y = 0; y < SIZE; ++y) {
+        std::uint64_t closed = m_repairing[y] & ~openRows[y];
+        for (int x = 0; closed != 0 && x < SIZE; ++x, closed >>= 1) {
+            if (!(closed & 1) || isRootedAt(x, y) || m_dist[x][y] == INFINITE)
+                continue;
+            int old = m_dist[x][y];
+            m_dist[x][y] = INFINITE;
+            for (int i = 0; i < 4; ++i) {
+                int nx = x + directions[i][0];
+                int ny = y + directions[i][1];
+                if (workingDistanceAt(nx, ny) == old + 1 && !m_queued[nx][ny]) {
+                    m_queued[nx][ny] = true;
+                    m_queue[(m_head + m_count++) % NODES] = static_cast<short>(nx * SIZE + ny);
+                }
+            }
+        }
+    }
+    m_numInvalid = 0;
+    m_phase = INVALIDATING;
+    return m_count;
+}
+
+// A position keeps its distance only while some neighbour is exactly one
+// step closer to the root; lost support spreads outward, one queued
+// position per call.
+void DistanceField::invalidateNext() {
+    int node = m_queue[m_head];
+    m_head = (m_head + 1) % NODES;
+    m_count--;
+    int x = node / SIZE;
+    int y = node % SIZE;
+    m_queued[x][y] = false;
+    if (isRootedAt(x, y) || m_dist[x][y] == INFINITE)
+        return;
+
+    int dist = m_dist[x][y];
+    bool supported = false;
+    for (int i = 0; i < 4 && !supported; ++i)
+        supported = workingDistanceAt(x + directions[i][0], y + directions[i][1]) == dist - 1;
+    if (supported)
+        return;
+
+    m_dist[x][y] = INFINITE;
+    m_seeds[m_numInvalid++] = node;
+    for (int i = 0; i < 4; ++i) {
+        int nx = x + directions[i][0];
+        int ny = y + directions[i][1];
+        if (workingDistanceAt(nx, ny) == dist + 1 && !m_queued[nx][ny]) {
+            m_queued[nx][ny] = true;
+            m_queue[(m_head + m_count++) % NODES] = static_cast<short>(nx * SIZE + ny);
+        }
+    }
+}
+
+// Once invalidation is done, invalidated and newly walkable positions take
+// the best distance their neighbours offer and seed the propagation. A newly
+// walkable position may already hold a distance: if it opened while a
+// sliced compute or repair was under way, that run can have reached it from
+// a farther neighbour. Returns the number of positions examined.
+int DistanceField::seedRepair(const std::uint64_t* openRows) {
+    int numSeeds = 0;
+    for (int i = 0; i < m_numInvalid; ++i) {
+        if (lowerToNeighbours(m_seeds[i] / SIZE, m_seeds[i] % SIZE))
+            m_seeds[numSeeds++] = m_seeds[i];
+    }
+    int examined = m_numInvalid;
+    for (int y = 0; y < SIZE; ++y) {
+        std::uint64_t opened = m_repairing[y] & openRows[y];
+        for (int x = 0; opened != 0 && x < SIZE; ++x, opened >>= 1) {
+            if (!(opened & 1) || isRootedAt(x, y))
+                continue;
+            examined++;
+            if (lowerToNeighbours(x, y))
+                m_seeds[numSeeds++] = x * SIZE + y;
+        }
+    }
+    std::sort(m_seeds, m_seeds + numSeeds, [this](int a, int b) {
+        return m_dist[a / SIZE][a % SIZE] < m_dist[b / SIZE][b % SIZE];
+    });
+    beginPropagate(numSeeds);
+    return examined;
+}
+
+// Gives (x, y) one more than its closest neighbour's distance if that is
+// shorter than its own, and returns whether it did.
+bool DistanceField::lowerToNeighbours(int x, int y) {
+    int best = m_dist[x][y];
+    for (int i = 0; i < 4; ++i) {
+        int nx = x + directions[i][0];
+        int ny = y + directions[i][1];
+        if (nx >= 0 && nx < SIZE && ny >= 0 && ny < SIZE)
+            best = std::min(best, m_dist[nx][ny] + 1);
+    }
+    if (best >= m_dist[x][y])
+        return false;
+    m_dist[x][y] = static_cast<short>(best);
+    return true;
+}
+
+// Breadth-first relaxation from m_seeds[0..numSeeds), which must already
+// hold their distances and be sorted by them. Seeds are merged with the
+// FIFO queue so positions are always expanded in non-decreasing distance.
+void DistanceField::beginPropagate(int numSeeds) {
+    m_numSeeds = numSeeds;
+    m_nextSeed = 0;
+    m_front = 0;
+    m_back = 0;
+    m_phase = PROPAGATING;
+    if (numSeeds == 0)
+        settle();
+}
+
+int DistanceField::advance(const std::uint64_t* openRows, int budget) {
+    int expanded = 0;
+    while (m_phase == INVALIDATING && expanded < budget) {
+        if (m_count > 0) {
+            invalidateNext();
+            expanded++;
+        } else {
+            expanded += seedRepair(openRows);
+        }
+    }
+    while (m_phase == PROPAGATING && expanded < budget) {
+        int node;
+        if (m_front == m_back || (m_nextSeed < m_numSeeds &&
+            m_dist[m_seeds[m_nextSeed] / SIZE][m_seeds[m_nextSeed] % SIZE] <=
+            m_dist[m_queue[m_front] / SIZE][m_queue[m_front] % SIZE]))
+            node = m_seeds[m_nextSeed++];
+        else
+            node = m_queue[m_front++];
+        expanded++;
+
+        int x = node / SIZE;
+        int y = node % SIZE;
+        for (int i = 0; i < 4; ++i) {
+            int nx = x + directions[i][0];
+            int ny = y + directions[i][1];
+            if (!isOpen(openRows, nx, ny) || m_dist[nx][ny] <= m_dist[x][y] + 1)
+                continue;
+            m_dist[nx][ny] = static_cast<short>(m_dist[x][y] + 1);
+            m_queue[m_back++] = static_cast<short>(nx * SIZE + ny);
+        }
+        if (m_nextSeed >= m_numSeeds && m_front >= m_back)
+            settle();
+    }
+    return expanded;
+}
+
+bool DistanceField::isOpen(const std::uint64_t* openRows, int x, int y) const {
+    if (x < 0 || x >= SIZE || y < 0 || y >= SIZE)
+        return false;
+    return (openRows[y] >> x) & 1;
+}
+
+// Ends the pending run and makes its distances the ones readers see.
+void DistanceField::settle() {
+    m_phase = SETTLED;
+    std::memcpy(m_result, m_dist, sizeof(m_result));
+    m_resultRootX = m_rootX;
+    m_resultRootY = m_rootY;
+}
+
+int DistanceField::distanceAt(int x, int y) const {
+    if (x < 0 || x >= SIZE || y < 0 || y >= SIZE || m_result[x][y] == INFINITE)
+        return UNREACHABLE;
+    return m_result[x][y];
+}
+
+int DistanceField::workingDistanceAt(int x, int y) const {
+    if (x < 0 || x >= SIZE || y < 0 || y >= SIZE || m_dist[x][y] == INFINITE)
+        return UNREACHABLE;
+    return m_dist[x][y];
+}
@@ -0,0 +1,86 @@
+#ifndef DISTANCEFIELD_H_
+#define DISTANCEFIELD_H_
+
+#include <cstdint>
+
+// Breadth-first step counts from a root position to every position a 4x4
+// actor can stand on. Walkability comes from one mask per row, as kept by
+// StudentWorld::m_openRows.
+//
+// After a full compute(), walkability changes can be reported through
+// markChanged() and folded in with repair(), which only revisits positions
+// whose distance is actually affected by the change.
+//
+// Either can also be run a slice at a time: beginCompute() or beginRepair()
+// followed by advance() until isSettled(). The field is double-buffered:
+// until a run settles, distanceAt() and the root getters keep answering from
+// the last settled result.
+class DistanceField {
+public:
+    static const int SIZE = 61;
+    static const int UNREACHABLE = -1;
+
+    DistanceField();
+
+    void compute(const std::uint64_t* openRows, int rootX, int rootY);
+    void repair(const std::uint64_t* openRows);
+    void beginCompute(int rootX, int rootY);
+    // Returns the number of positions it visited.
+    int beginRepair(const std::uint64_t* openRows);
+    // Expands at most budget positions of the pending compute or repair and
+    // returns how many it expanded.
+    int advance(const std::uint64_t* openRows, int budget);
+    void markChanged(int y, std::uint64_t cells);
+    void invalidate();
+
+    bool isSettled() const { return m_phase == SETTLED; }
+    bool hasChanges() const { return m_hasChanges; }
+    // true if the pending run, or the settled result, is rooted at (x, y)
+    bool isRootedAt(int x, int y) const { return m_rootX == x && m_rootY == y; }
+    // true once a compute has settled since the last invalidate()
+    bool hasResult() const { return m_resultRootX >= 0; }
+    // from the last settled result
+    int distanceAt(int x, int y) const;
+    int getRootX() const { return m_resultRootX; }
+    int getRootY() const { return m_resultRootY; }
+
+private:
+    static const int NODES = SIZE * SIZE;
+    static const short INFINITE = 0x7fff;
+
+    bool isOpen(const std::uint64_t* openRows, int x, int y) const;
+    int workingDistanceAt(int x, int y) const;
+    void resetWorking();
+    void settle();
+    void invalidateNext();
+    int seedRepair(const std::uint64_t* openRows);
+    bool lowerToNeighbours(int x, int y);
+    void beginPropagate(int numSeeds);
+
+    // m_dist is what runs work on; m_result is what readers see
+    short m_dist[SIZE][SIZE];
+    short m_result[SIZE][SIZE];
+    int m_resultRootX;
+    int m_resultRootY;
+    short m_queue[NODES];
+    bool m_queued[SIZE][SIZE];
+    int m_seeds[NODES];
+    std::uint64_t m_changed[SIZE];
+    bool m_hasChanges;
+
+    // progress of the pending compute or repair
+    enum Phase { SETTLED, INVALIDATING, PROPAGATING };
+    Phase m_phase;
+    std::uint64_t m_repairing[SIZE];
+    int m_head;
+    int m_count;
+    int m_numInvalid;
+    int m_numSeeds;
+    int m_nextSeed;
+    int m_front;
+    int m_back;
+    int m_rootX;
+    int m_rootY;
+};
+
+#endif // DISTANCEFIELD_H_
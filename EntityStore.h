@@ -0,0 +1,174 @@
+#ifndef ENTITYSTORE_H_
+#define ENTITYSTORE_H_
+
+#include <cstdint>
+#include <vector>
+
+// Refers to an object in an EntityStore. A handle whose object has been
+// removed, or whose store has been cleared, no longer resolves.
+struct ActorHandle {
+    std::uint32_t slot;
+    std::uint32_t generation;
+};
+
+const ActorHandle NO_ACTOR = { 0xffffffffu, 0 };
+
+inline bool operator==(ActorHandle a, ActorHandle b) {
+    return a.slot == b.slot && a.generation == b.generation;
+}
+
+// Keeps the fields every per-tick sweep needs (position, type, alive,
+// asleep) in parallel arrays in insertion order, next to the object
+// pointers, so sweeps read them without touching the objects. Handles go
+// through a slot table with a generation count per slot, so a handle used
+// after its entry was removed is detected instead of dangling.
+template <typename T>
+class EntityStore {
+public:
+    EntityStore() {
+        m_objects.reserve(128);
+        m_x.reserve(128);
+        m_y.reserve(128);
+        m_type.reserve(128);
+        m_alive.reserve(128);
+        m_asleep.reserve(128);
+        m_slotOf.reserve(128);
+        m_indexOf.reserve(128);
+        m_generation.reserve(128);
+        m_freeSlots.reserve(128);
+    }
+
+    ActorHandle add(T* object, int x, int y, int type) {
+        std::uint32_t slot;
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            slot = static_cast<std::uint32_t>(m_indexOf.size());
+            m_indexOf.push_back(0);
+            m_generation.push_back(0);
+        }
+        m_indexOf[slot] = static_cast<std::uint32_t>(m_objects.size());
+        m_objects.push_back(object);
+        m_x.push_back(static_cast<short>(x));
+        m_y.push_back(static_cast<short>(y));
+        m_type.push_back(static_cast<unsigned char>(type));
+        m_alive.push_back(1);
+        m_asleep.push_back(0);
+        m_slotOf.push_back(slot);
+        return { slot, m_generation[slot] };
+    }
+
+    // The object handle refers to, or nullptr if its entry has been removed.
+    T* get(ActorHandle handle) const {
+        if (!isValid(handle))
+            return nullptr;
+        return m_objects[m_indexOf[handle.slot]];
+    }
+
+    bool isValid(ActorHandle handle) const {
+        return handle.slot < m_generation.size() && m_generation[handle.slot] == handle.generation;
+    }
+
+    void setPosition(ActorHandle handle, int x, int y) {
+        if (!isValid(handle))
+            return;
+        std::uint32_t i = m_indexOf[handle.slot];
+        m_x[i] = static_cast<short>(x);
+        m_y[i] = static_cast<short>(y);
+    }
+
+    void markDead(ActorHandle handle) {
+        if (isValid(handle))
+            m_alive[m_indexOf[handle.slot]] = 0;
+    }
+
+    // A sleeping entry stays in the store but is skipped by update passes
+    // until it is woken.
+    void setAsleep(ActorHandle handle, bool asleep) {
+        if (isValid(handle))
+            m_asleep[m_indexOf[handle.slot]] = asleep ? 1 : 0;
+    }
+
+    void setAsleepAt(std::size_t i, bool asleep) { m_asleep[i] = asleep ? 1 : 0; }
+
+    bool isAsleep(ActorHandle handle) const {
+        return isValid(handle) && m_asleep[m_indexOf[handle.slot]] != 0;
+    }
+
+    // Drops every dead entry in one stable pass, handing each object to
+    // release(object) and retiring its handle.
+    template <typename Release>
+    void removeDead(Release release) {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < m_objects.size(); ++i) {
+            if (!m_alive[i]) {
+                retire(m_slotOf[i]);
+                release(m_objects[i]);
+                continue;
+            }
+            if (kept != i) {
+                m_objects[kept] = m_objects[i];
+                m_x[kept] = m_x[i];
+                m_y[kept] = m_y[i];
+                m_type[kept] = m_type[i];
+                m_alive[kept] = m_alive[i];
+                m_asleep[kept] = m_asleep[i];
+                m_slotOf[kept] = m_slotOf[i];
+                m_indexOf[m_slotOf[kept]] = static_cast<std::uint32_t>(kept);
+            }
+            kept++;
+        }
+        resize(kept);
+    }
+
+    // Retires every handle and empties the store.
+    void clear() {
+        for (std::size_t i = 0; i < m_objects.size(); ++i)
+            retire(m_slotOf[i]);
+        resize(0);
+    }
+
+    std::size_t size() const { return m_objects.size(); }
+    T* objectAt(std::size_t i) const { return m_objects[i]; }
+    bool isAliveAt(std::size_t i) const { return m_alive[i] != 0; }
+    bool isAsleepAt(std::size_t i) const { return m_asleep[i] != 0; }
+    // index of handle's entry, or size() if the handle is stale
+    std::size_t positionOf(ActorHandle handle) const { return isValid(handle) ? m_indexOf[handle.slot] : m_objects.size(); }
+    int xAt(std::size_t i) const { return m_x[i]; }
+    int yAt(std::size_t i) const { return m_y[i]; }
+    int typeAt(std::size_t i) const { return m_type[i]; }
+    const std::vector<T*>& objects() const { return m_objects; }
+
+private:
+    void retire(std::uint32_t slot) {
+        m_generation[slot]++;
+        m_freeSlots.push_back(slot);
+    }
+
+    void resize(std::size_t n) {
+        m_objects.resize(n);
+        m_x.resize(n);
+        m_y.resize(n);
+        m_type.resize(n);
+        m_alive.resize(n);
+        m_asleep.resize(n);
+        m_slotOf.resize(n);
+    }
+
+    // dense, in insertion order
+    std::vector<T*> m_objects;
+    std::vector<short> m_x;
+    std::vector<short> m_y;
+    std::vector<unsigned char> m_type;
+    std::vector<unsigned char> m_alive;
+    std::vector<unsigned char> m_asleep;
+    std::vector<std::uint32_t> m_slotOf;
+
+    // indexed by handle slot
+    std::vector<std::uint32_t> m_indexOf;
+    std::vector<std::uint32_t> m_generation;
+    std::vector<std::uint32_t> m_freeSlots;
+};
+
+#endif // ENTITYSTORE_H_
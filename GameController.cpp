@@ -61,7 +61,7 @@ struct SpriteInfo
 
 static void convertToGlutCoords(double x, double y, double& gx, double& gy, double& gz);
 static void drawPrompt(string mainMessage, string secondMessage);
-static void drawScoreAndLives(string);
+static void drawScoreAndLives(const string&);
 
 void GameController::initDrawersAndSounds()
 {
@@ -116,8 +116,12 @@ void GameController::initDrawersAndSounds()
 		if (!m_spriteManager.loadSprite(path + d.tgaFileName, d.imageID, d.frameNum))
 			exit(0);
 	}
+	  // Store full paths so playing a sound doesn't have to build one.
+	string soundPath = m_gw->assetDirectory();
+	if (!soundPath.empty())
+		soundPath += '/';
 	for (int k = 0; k < sizeof(sounds)/sizeof(sounds[0]); k++)
-		m_soundMap[sounds[k].first] = sounds[k].second;
+		m_soundMap[sounds[k].first] = soundPath + sounds[k].second;
 }
 
 static void doSomethingCallback()
@@ -155,6 +159,7 @@ void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTit
 	m_singleStep = false;
 	m_curIntraFrameTick = 0;
 	m_playerWon = false;
+	m_gameStatText.reserve(128);
 
 	glutInit(&argc, argv);
 
@@ -211,12 +216,7 @@ void GameController::playSound(int soundID)
 
 	SoundMapType::const_iterator p = m_soundMap.find(soundID);
 	if (p != m_soundMap.end())
-	{
-		string path = m_gw->assetDirectory();
-		if (!path.empty())
-			path += '/';
-		SoundFX().playClip(path + p->second);
-	}
+		SoundFX().playClip(p->second);
 }
 
 void GameController::doSomething()
@@ -362,6 +362,24 @@ void GameController::drawEarth(double gx, double gy, double gz, double size)
 
 }
 
+void GameController::displayEarth()
+{
+	int numRows;
+	const std::uint64_t* rows = m_gw->getEarthRows(numRows);
+	for (int y = 0; y < numRows; y++)
+	{
+		for (int x = 0; x < 64; x++)
+		{
+			if (((rows[y] >> x) & 1) == 0)
+				continue;
+
+			double gx, gy, gz;
+			convertToGlutCoords(x, y, gx, gy, gz);
+			drawEarth(gx, gy, gz, .25);
+		}
+	}
+}
+
 void GameController::displayGamePlay()
 {
 	glEnable(GL_DEPTH_TEST); // must be done each time before displaying graphics or gets disabled for some reason
@@ -371,46 +389,46 @@ void GameController::displayGamePlay()
 
 	for (int i = NUM_LAYERS - 1; i >= 0; --i)
 	{
-		std::set<GraphObject*> &graphObjects = GraphObject::getGraphObjects(i);
+		if (i == EARTH_LAYER)
+			displayEarth();
+
+		std::vector<GraphObject*> &graphObjects = GraphObject::getGraphObjects(i);
 
-		for (auto it = graphObjects.begin(); it != graphObjects.end(); it++)
+		for (std::size_t k = 0; k < graphObjects.size(); k++)
 		{
-			GraphObject* cur = *it;
-			if (cur->isVisible())
-			{
-				cur->animate();
+			GraphObject* cur = graphObjects[k];
+			cur->animate();
 
-				double x, y, gx, gy, gz;
-				cur->getAnimationLocation(x, y);
-				convertToGlutCoords(x, y, gx, gy, gz);
+			double x, y, gx, gy, gz;
+			cur->getAnimationLocation(x, y);
+			convertToGlutCoords(x, y, gx, gy, gz);
 
-				SpriteManager::Angle angle;
-				switch (cur->getDirection())
-				{
-				case GraphObject::up:
-					angle = SpriteManager::face_up;
-					break;
-				case GraphObject::down:
-					angle = SpriteManager::face_down;
-					break;
-				case GraphObject::left:
-					angle = SpriteManager::face_left;
-					break;
-				case GraphObject::right:
-				case GraphObject::none:
-				default:
-					angle = SpriteManager::face_right;
-					break;
-				}
+			SpriteManager::Angle angle;
+			switch (cur->getDirection())
+			{
+			case GraphObject::up:
+				angle = SpriteManager::face_up;
+				break;
+			case GraphObject::down:
+				angle = SpriteManager::face_down;
+				break;
+			case GraphObject::left:
+				angle = SpriteManager::face_left;
+				break;
+			case GraphObject::right:
+			case GraphObject::none:
+			default:
+				angle = SpriteManager::face_right;
+				break;
+			}
 
-				int imageID = cur->getID();
+			int imageID = cur->getID();
 
-				// the specialized Earth plotting is an optimization to deal with the background Earth, which requires a lot of horsepower to plot
-				if (imageID == TID_EARTH)
-					drawEarth(gx, gy, gz, cur->getSize());
-				else
-					m_spriteManager.plotSprite(imageID, cur->getAnimationNumber() % m_spriteManager.getNumFrames(imageID), gx, gy, gz, angle, cur->getSize());
-			}
+			// the specialized Earth plotting is an optimization to deal with the background Earth, which requires a lot of horsepower to plot
+			if (imageID == TID_EARTH)
+				drawEarth(gx, gy, gz, cur->getSize());
+			else
+				m_spriteManager.plotSprite(imageID, cur->getAnimationNumber() % m_spriteManager.getNumFrames(imageID), gx, gy, gz, angle, cur->getSize());
 		}
 	}
 
@@ -476,7 +494,7 @@ static void drawPrompt(string mainMessage, string secondMessage)
 	glutSwapBuffers();
 }
 
-static void drawScoreAndLives(string gameStatText)
+static void drawScoreAndLives(const string& gameStatText)
 {
 	static int RATE = 1;
 	static GLfloat rgb[3] =
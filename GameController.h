@@ -34,7 +34,7 @@ class GameController
 
 	void playSound(int soundID);
 
-	void setGameStatText(std::string text)
+	void setGameStatText(const std::string& text)
 	{
 		m_gameStatText = text;
 	}
@@ -82,6 +82,7 @@ private:
 
 	void initDrawersAndSounds();
 	void displayGamePlay();
+	void displayEarth();
 	void drawEarth(double gx, double gy, double gz, double size);	// optimized - does not use sprite engine
 };
 
@@ -3,6 +3,7 @@
 
 #include "GameConstants.h"
 #include <string>
+#include <cstdint>
 
 const int START_PLAYER_LIVES = 3;
 
@@ -26,7 +27,7 @@ public:
 	virtual int move() = 0;
 	virtual void cleanUp() = 0;
 
-	void setGameStatText(std::string text);
+	void setGameStatText(const std::string& text);
 
 	bool getKey(int& value);
 	void playSound(int soundID);
@@ -82,6 +83,14 @@ public:
 	{
 		return m_assetDir;
 	}
+
+	  // Earth is not made of GraphObjects; the framework draws it from one
+	  // mask per row, where bit x of row y is set if (x, y) holds Earth.
+	virtual const std::uint64_t* getEarthRows(int& numRows) const
+	{
+		numRows = 0;
+		return nullptr;
+	}
 	
 private:
 	unsigned int	m_lives;
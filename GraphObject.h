@@ -4,11 +4,12 @@
 #include "SpriteManager.h"
 #include "GameConstants.h"
 
-#include <set>
+#include <vector>
 #include <cmath>
 
 const int ANIMATION_POSITIONS_PER_TICK = 1;
 const int NUM_LAYERS = 4;
+const int EARTH_LAYER = 3;
 
 inline int roundAwayFromZero(double r)
 {
@@ -24,47 +25,76 @@ class GraphObject
 	enum Direction { none, up, down, left, right };
 
 	GraphObject(int imageID, int startX, int startY, Direction dir = right, double size = 1.0, unsigned int depth = 0)
-	 : m_imageID(imageID), m_visible(false), m_x(startX), m_y(startY),
-	   m_destX(startX), m_destY(startY), m_brightness(1.0),
-	   m_animationNumber(0), m_direction(dir), m_size(size), m_depth(depth)
+	 : m_imageID(imageID), m_animationNumber(0), m_direction(dir),
+	   m_destX(static_cast<short>(startX)), m_destY(static_cast<short>(startY)),
+	   m_depth(static_cast<unsigned char>(depth)), m_visible(false),
+	   m_registryIndex(-1), m_brightness(1.0f), m_size(static_cast<float>(size))
 	{
 		if (m_size <= 0)
 			m_size = 1;
-
-		getGraphObjects(m_depth).insert(this);
+		m_anim.x = static_cast<float>(startX);
+		m_anim.y = static_cast<float>(startY);
 	}
 
 	virtual ~GraphObject()
 	{
-		getGraphObjects(m_depth).erase(this);
+		setVisible(false);
 	}
 
+	  // Only visible objects are listed in their layer's registry, so showing
+	  // or hiding an object adds it to or swap-removes it from that list.
 	void setVisible(bool shouldIDisplay)
 	{
 		m_visible = shouldIDisplay;
+		if (shouldIDisplay && m_registryIndex < 0)
+		{
+			std::vector<GraphObject*>& graphObjects = getGraphObjects(m_depth);
+			m_registryIndex = static_cast<int>(graphObjects.size());
+			graphObjects.push_back(this);
+		}
+		else if (!shouldIDisplay && m_registryIndex >= 0)
+		{
+			std::vector<GraphObject*>& graphObjects = getGraphObjects(m_depth);
+			GraphObject* last = graphObjects.back();
+			graphObjects[m_registryIndex] = last;
+			last->m_registryIndex = m_registryIndex;
+			graphObjects.pop_back();
+			m_registryIndex = -1;
+		}
 	}
 
 	void setBrightness(double brightness)
 	{
-		m_brightness = brightness;
+		m_brightness = static_cast<float>(brightness);
 	}
 
 	int getX() const
 	{
 		  // If already moved but not yet animated, use new location anyway.
-		return roundAwayFromZero(m_destX);
+		return m_destX;
 	}
 
 	int getY() const
 	{
 		  // If already moved but not yet animated, use new location anyway.
-		return roundAwayFromZero(m_destY);
+		return m_destY;
 	}
 
 	void moveTo(int x, int y)
 	{
-		m_destX = x;
-		m_destY = y;
+		m_destX = static_cast<short>(x);
+		m_destY = static_cast<short>(y);
+		increaseAnimationNumber();
+	}
+
+	  // Like moveTo, but without animating the trip (used when an object
+	  // is recycled at a new location).
+	void teleportTo(int x, int y)
+	{
+		m_destX = static_cast<short>(x);
+		m_destY = static_cast<short>(y);
+		m_anim.x = static_cast<float>(x);
+		m_anim.y = static_cast<float>(y);
 		increaseAnimationNumber();
 	}
 
@@ -107,52 +137,77 @@ class GraphObject
 
 	void getAnimationLocation(double& x, double& y) const
 	{
-		x = m_x;
-		y = m_y;
+		x = m_anim.x;
+		y = m_anim.y;
 	}
 
 	void animate()
 	{
 		// m_animationNumber++;
-		moveALittle(m_x, m_destX);
-		moveALittle(m_y, m_destY);
+		moveALittle(m_anim.x, m_destX);
+		moveALittle(m_anim.y, m_destY);
 	}
 
-	static std::set<GraphObject*>& getGraphObjects(unsigned int layer)
+	  // The visible objects in a layer, in the order they were shown (with
+	  // swap-removal on hide).
+	static std::vector<GraphObject*>& getGraphObjects(unsigned int layer)
 	{
-		static std::set<GraphObject*> graphObjects[NUM_LAYERS];
+		static std::vector<GraphObject*>* graphObjects = makeRegistries();
 		if (layer < NUM_LAYERS)
 			return graphObjects[layer];
 		else
 			return graphObjects[0];		// empty;
 	}
 
+	  // Empties every layer's registry without destroying the objects in it.
+	static void clearGraphObjects()
+	{
+		for (unsigned int i = 0; i < NUM_LAYERS; i++)
+			getGraphObjects(i).clear();
+	}
+
   private:
 	  // Prevent copying or assigning GraphObjects
 	GraphObject(const GraphObject&);
 	GraphObject& operator=(const GraphObject&);
 
+	  // Where the object is drawn, which trails the logical position while
+	  // a move is being animated.  Only the renderer looks at this.
+	struct AnimationState
+	{
+		float	x;
+		float	y;
+	};
+
 	int		m_imageID;
-	bool	m_visible;
-	double	m_x;
-	double	m_y;
-	double	m_destX;
-	double	m_destY;
-	double	m_brightness;
 	int		m_animationNumber;
 	Direction	m_direction;
-	double	m_size;
-	int		m_depth;
+	short	m_destX;	// logical position
+	short	m_destY;
+	unsigned char	m_depth;
+	bool	m_visible;
+	int		m_registryIndex;	// position in the layer's registry, or -1
+	float	m_brightness;
+	float	m_size;
+	AnimationState	m_anim;
+
+	static std::vector<GraphObject*>* makeRegistries()
+	{
+		static std::vector<GraphObject*> graphObjects[NUM_LAYERS];
+		for (int i = 0; i < NUM_LAYERS; i++)
+			graphObjects[i].reserve(256);
+		return graphObjects;
+	}
 
-	void moveALittle(double& from, double& to)
+	void moveALittle(float& from, int to)
 	{
-		static const double DISTANCE = 1.0/ANIMATION_POSITIONS_PER_TICK;
+		static const float DISTANCE = 1.0f/ANIMATION_POSITIONS_PER_TICK;
 		if (to - from >= DISTANCE)
 			from += DISTANCE;
 		else if (from - to >= DISTANCE)
 			from -= DISTANCE;
 		else
-			from = to;
+			from = static_cast<float>(to);
 	}
 
 	void increaseAnimationNumber()
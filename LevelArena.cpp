@@ -0,0 +1,35 @@
+#include "LevelArena.h"
+#include <cstdint>
+
+LevelArena::LevelArena(std::size_t chunkSize)
+    : m_chunkSize(chunkSize), m_current(0), m_offset(0) {
+}
+
+LevelArena::~LevelArena() {
+    for (const Chunk& chunk : m_chunks)
+        delete[] chunk.data;
+}
+
+void* LevelArena::allocate(std::size_t size, std::size_t alignment) {
+    while (m_current < m_chunks.size()) {
+        const Chunk& chunk = m_chunks[m_current];
+        std::uintptr_t base = reinterpret_cast<std::uintptr_t>(chunk.data);
+        std::uintptr_t start = (base + m_offset + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+        if (start + size <= base + chunk.size) {
+            m_offset = start + size - base;
+            return chunk.data + (start - base);
+        }
+        m_current++;
+        m_offset = 0;
+    }
+
+    std::size_t chunkSize = size + alignment > m_chunkSize ? size + alignment : m_chunkSize;
+    m_chunks.push_back({ new unsigned char[chunkSize], chunkSize });
+    m_current = m_chunks.size() - 1;
+    return allocate(size, alignment);
+}
+
+void LevelArena::reset() {
+    m_current = 0;
+    m_offset = 0;
+}
@@ -0,0 +1,42 @@
+#ifndef LEVELARENA_H_
+#define LEVELARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Bump allocator for objects that live no longer than one level (or one
+// life). Nothing is freed individually: reset() rewinds the arena in one
+// step and keeps its chunks, so the next level allocates from the same
+// memory. Objects created here are never destroyed by the arena, so their
+// owner must not depend on their destructors running at reset().
+class LevelArena {
+public:
+    explicit LevelArena(std::size_t chunkSize = 64 * 1024);
+    ~LevelArena();
+
+    void* allocate(std::size_t size, std::size_t alignment);
+    void reset();
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+private:
+    struct Chunk {
+        unsigned char* data;
+        std::size_t size;
+    };
+
+    LevelArena(const LevelArena&);
+    LevelArena& operator=(const LevelArena&);
+
+    std::vector<Chunk> m_chunks;
+    std::size_t m_chunkSize;
+    std::size_t m_current;
+    std::size_t m_offset;
+};
+
+#endif // LEVELARENA_H_
@@ -0,0 +1,126 @@
+#ifndef PATHCACHE_H_
+#define PATHCACHE_H_
+
+#include "DistanceField.h"
+#include "GraphObject.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+// One actor's route down a distance field, recorded step by step so it can
+// be replayed without consulting the field again. The cache remembers the
+// field's root, the terrain version it was recorded at and the terrain
+// regions in which a change could alter the route; whoever owns the terrain
+// decides from those whether the route still holds.
+class PathCache {
+public:
+    typedef GraphObject::Direction Direction;
+
+    static const int MAX_STEPS = 64;
+    // positions per side of a terrain region; a 61x61 field is 8x8 regions
+    static const int REGION_SIZE = 8;
+
+    PathCache() { clear(); }
+
+    void clear() {
+        m_length = 0;
+        m_next = 0;
+        m_complete = false;
+        m_regions = 0;
+        m_version = 0;
+        m_rootX = m_rootY = -1;
+        m_atX = m_atY = -1;
+    }
+
+    static int regionOf(int x, int y) { return (y / REGION_SIZE) * 8 + x / REGION_SIZE; }
+
+    // Follows field downhill from (x, y), which must be settled, for up to
+    // MAX_STEPS steps, preferring the same neighbours the actors do.
+    void record(const DistanceField& field, int x, int y, std::uint32_t version) {
+        clear();
+        m_rootX = field.getRootX();
+        m_rootY = field.getRootY();
+        m_version = version;
+        m_atX = x;
+        m_atY = y;
+        int dist = field.distanceAt(x, y);
+        if (dist > 0)
+            m_regions = regionsNear(x, y, m_rootX, m_rootY, dist);
+        while (dist > 0 && m_length < MAX_STEPS) {
+            Direction dir;
+            if (field.distanceAt(x - 1, y) == dist - 1) { dir = GraphObject::left; --x; }
+            else if (field.distanceAt(x + 1, y) == dist - 1) { dir = GraphObject::right; ++x; }
+            else if (field.distanceAt(x, y - 1) == dist - 1) { dir = GraphObject::down; --y; }
+            else if (field.distanceAt(x, y + 1) == dist - 1) { dir = GraphObject::up; ++y; }
+            else break;
+            m_steps[m_length++] = dir;
+            dist--;
+        }
+        m_complete = dist == 0;
+    }
+
+    // True if the recorded route leads from (x, y) to (rootX, rootY) and
+    // has a step left; that step is stored in dir.
+    bool nextStep(int x, int y, int rootX, int rootY, Direction& dir) const {
+        if (m_next >= m_length || x != m_atX || y != m_atY || rootX != m_rootX || rootY != m_rootY)
+            return false;
+        dir = m_steps[m_next];
+        return true;
+    }
+
+    // Moves past the step nextStep() returned.
+    void advance() {
+        switch (m_steps[m_next++]) {
+            case GraphObject::left: m_atX--; break;
+            case GraphObject::right: m_atX++; break;
+            case GraphObject::down: m_atY--; break;
+            case GraphObject::up: m_atY++; break;
+            default: break;
+        }
+    }
+
+    // Steps from (x, y) to (rootX, rootY) along the route, or -1 if the
+    // route does not start there, lead there or reach it.
+    int stepsLeft(int x, int y, int rootX, int rootY) const {
+        if (!m_complete || x != m_atX || y != m_atY || rootX != m_rootX || rootY != m_rootY)
+            return -1;
+        return m_length - m_next;
+    }
+
+    // The regions holding every position p with |p - (x, y)| + |p - root|
+    // <= dist, in steps. Only opening such a position can shorten a route
+    // of dist steps from (x, y), or from any position along it, or tie
+    // with it; closing a position can only lengthen the route if the route
+    // passes through it, and the route lies in the same set.
+    static std::uint64_t regionsNear(int x, int y, int rootX, int rootY, int dist) {
+        int slack = (dist - std::abs(x - rootX) - std::abs(y - rootY)) / 2;
+        int minX = std::max(std::min(x, rootX) - slack, 0);
+        int maxX = std::min(std::max(x, rootX) + slack, DistanceField::SIZE - 1);
+        int minY = std::max(std::min(y, rootY) - slack, 0);
+        int maxY = std::min(std::max(y, rootY) + slack, DistanceField::SIZE - 1);
+        std::uint64_t regions = 0;
+        for (int ry = minY / REGION_SIZE; ry <= maxY / REGION_SIZE; ++ry) {
+            for (int rx = minX / REGION_SIZE; rx <= maxX / REGION_SIZE; ++rx)
+                regions |= 1ULL << (ry * 8 + rx);
+        }
+        return regions;
+    }
+
+    std::uint64_t getRegions() const { return m_regions; }
+    std::uint32_t getVersion() const { return m_version; }
+
+private:
+    Direction m_steps[MAX_STEPS];
+    int m_length;
+    int m_next;
+    bool m_complete;
+    std::uint64_t m_regions;
+    std::uint32_t m_version;
+    int m_rootX;
+    int m_rootY;
+    // where the actor stands before m_steps[m_next]
+    int m_atX;
+    int m_atY;
+};
+
+#endif // PATHCACHE_H_
@@ -13,7 +13,7 @@ class SoundFXController
 {
   public:
 
-	void playClip(std::string soundFile)
+	void playClip(const std::string& soundFile)
 	{
 		if (m_engine != nullptr)
 			m_engine->play2D(soundFile.c_str(), false);
@@ -55,7 +55,7 @@ class SoundFXController
 class SoundFXController
 {
   public:
-	void playClip(std::string soundFile)
+	void playClip(const std::string& soundFile)
 	{
 		std::system(("/usr/bin/afplay \"" + soundFile + "\" &").c_str());
 	}
@@ -72,7 +72,7 @@ class SoundFXController
 class SoundFXController
 {
   public:
-	void playClip(std::string soundFile) {}
+	void playClip(const std::string& soundFile) {}
 	void abortClip() {}
 	static SoundFXController& getInstance();
 };
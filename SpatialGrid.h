@@ -0,0 +1,79 @@
+#ifndef SPATIALGRID_H_
+#define SPATIALGRID_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Buckets keys by position so radius queries only look at nearby cells.
+// The grid keeps no positions of its own beyond the cell each key is in;
+// a query hands every key in the overlapping cells to the caller, which
+// filters them against its own position and type data.
+template <typename Key>
+class SpatialGrid {
+public:
+    static const int CELL_SIZE = 4;
+    static const int CELLS = 64 / CELL_SIZE;
+
+    static unsigned typeBit(int imageID) { return 1u << imageID; }
+
+    SpatialGrid() {
+        for (auto& bucket : m_buckets)
+            bucket.reserve(16);
+    }
+
+    void insert(Key key, int x, int y) {
+        m_buckets[cellOf(x, y)].push_back(key);
+    }
+
+    void remove(Key key, int x, int y) {
+        std::vector<Key>& bucket = m_buckets[cellOf(x, y)];
+        for (auto& entry : bucket) {
+            if (entry == key) {
+                entry = bucket.back();
+                bucket.pop_back();
+                return;
+            }
+        }
+    }
+
+    void move(Key key, int oldX, int oldY, int newX, int newY) {
+        if (cellOf(newX, newY) == cellOf(oldX, oldY))
+            return;
+        remove(key, oldX, oldY);
+        insert(key, newX, newY);
+    }
+
+    void clear() {
+        for (auto& bucket : m_buckets)
+            bucket.clear();
+    }
+
+    // Calls visit(key) for every key in a cell that overlaps the square
+    // around (x, y) with half-side radius. Stops early if visit returns
+    // false. The grid must not be modified from inside visit.
+    template <typename Visitor>
+    void forEachNear(int x, int y, double radius, Visitor visit) const {
+        int r = static_cast<int>(std::ceil(radius));
+        int minCX = clampCell((x - r) / CELL_SIZE);
+        int maxCX = clampCell((x + r) / CELL_SIZE);
+        int minCY = clampCell((y - r) / CELL_SIZE);
+        int maxCY = clampCell((y + r) / CELL_SIZE);
+        for (int cy = minCY; cy <= maxCY; ++cy) {
+            for (int cx = minCX; cx <= maxCX; ++cx) {
+                for (Key key : m_buckets[cy * CELLS + cx]) {
+                    if (!visit(key))
+                        return;
+                }
+            }
+        }
+    }
+
+private:
+    static int clampCell(int c) { return std::min(std::max(c, 0), CELLS - 1); }
+    static int cellOf(int x, int y) { return clampCell(y / CELL_SIZE) * CELLS + clampCell(x / CELL_SIZE); }
+
+    std::vector<Key> m_buckets[CELLS * CELLS];
+};
+
+#endif // SPATIALGRID_H_
@@ -1,18 +1,30 @@
 #include "StudentWorld.h"
 #include "Actor.h"
+#include "ActorPool.h"
+#include "AllocationCounter.h"
 #include <cmath>
-#include <iomanip>
 #include <vector>
 #include <algorithm>
-#include <sstream>
+#include <cstdio>
+#include <bitset>
+#include <climits>
 
 using namespace std;
 
 StudentWorld::StudentWorld(std::string assetDir)
-    : GameWorld(assetDir), m_tunnelman(nullptr), m_ticks(0) {
-    for (int x = 0; x < 64; ++x)
-        for (int y = 0; y < 60; ++y)
-            m_earth[x][y] = nullptr;
+    : GameWorld(assetDir), m_tunnelman(nullptr), m_liveProtesters(0),
+      m_squirtPool(nullptr), m_goldPool(nullptr), m_waterPool(nullptr), m_sonarPool(nullptr),
+      m_regularPool(nullptr), m_hardcorePool(nullptr), m_updateOrder(UPDATE_INTERLEAVED), m_detailRadius(0),
+      m_passStage(AFTER_PASS), m_passIndex(0),
+      m_exitFieldTick(-1), m_tunnelmanFieldTick(-1), m_pathBudget(0), m_pathBudgetLeft(0),
+      m_pathCaching(true), m_terrainVersion(0), m_ticks(0) {
+    m_spawnQueue.reserve(16);
+    m_protesters.reserve(32);
+    m_boulders.reserve(16);
+    m_pickups.reserve(64);
+    m_projectiles.reserve(16);
+    m_statText.reserve(128);
+    clearTerrain();
 }
 
 StudentWorld::~StudentWorld() {
@@ -21,33 +33,41 @@ StudentWorld::~StudentWorld() {
 
 bool StudentWorld::annoyProtestersAt(int x, int y, double radius, int amount) {
     bool annoyed = false;
-    for (auto actor : m_everything) {
-        if (actor->isProtester()) {
-            double dist = sqrt(pow(actor->getX() - x, 2) + pow(actor->getY() - y, 2));
-            if (dist <= radius) {
-                actor->annoy(amount);
-                annoyed = true;
-            }
-        }
-    }
+    queryRadius(x, y, radius, protesterTypes(), [&](BaseForEverything* actor) {
+        actor->annoy(amount);
+        annoyed = true;
+        return true;
+    });
     return annoyed;
 }
 
 int StudentWorld::init() {
 
     m_ticks = 0;
+    m_timers.clear(0);
+    m_passStage = AFTER_PASS;
+    m_exitFieldTick = -1;
+    m_tunnelmanFieldTick = -1;
     int T = std::max(25, 200 - static_cast<int>(getLevel()));
     m_ticksSinceLastProtester = T;
 
+    const std::uint64_t tunnel = 0xFULL << 30;
+    for (int y = 0; y < 60; ++y)
+        m_earthRows[y] = y >= 4 ? ~tunnel : ~0ULL;
     for (int x = 0; x < 64; ++x) {
         for (int y = 0; y < 60; ++y) {
-            if (x >= 30 && x <= 33 && y >= 4 && y <= 59)
-                m_earth[x][y] = nullptr;
-            else
-                m_earth[x][y] = new Earth(this, x, y);
+            if ((m_earthRows[y] >> x) & 1)
+                m_earthCols[x] |= 1ULL << y;
         }
     }
-    m_tunnelman = new Tunnelman(this);
+    updateOpenRows(0, 60);
+    m_tunnelman = m_arena.create<Tunnelman>(this);
+    m_squirtPool = m_arena.create<ActorPool<Squirt, 16>>();
+    m_goldPool = m_arena.create<ActorPool<GoldNugget, 16>>();
+    m_waterPool = m_arena.create<ActorPool<WaterPool, 8>>();
+    m_sonarPool = m_arena.create<ActorPool<SonarKit, 4>>();
+    m_regularPool = m_arena.create<ActorPool<RegularProtester, 16>>();
+    m_hardcorePool = m_arena.create<ActorPool<HardcoreProtester, 16>>();
     int level = getLevel();
     int G = std::max(5 - level / 2, 2);
 
@@ -74,14 +94,11 @@ int StudentWorld::init() {
                 }
             }
         } while (!validPosition);
-        for (int i = x; i < x + 4 && i < 64; ++i) {
-            for (int j = y; j < y + 4 && j < 60; ++j) {
-                delete m_earth[i][j];
-                m_earth[i][j] = nullptr;
-            }
-        }
-        Boulder* boulder = new Boulder(this, x, y);
-        m_everything.push_back(boulder);
+        for (int j = y; j < y + 4 && j < 60; ++j)
+            clearEarthBits(j, 0xFULL << x);
+        updateOpenRows(y, y + 3);
+        Boulder* boulder = m_arena.create<Boulder>(this, x, y);
+        addActor(boulder);
         objectPositions.push_back({x, y});
     }
     for (int i = 0; i < G; ++i) {
@@ -95,18 +112,7 @@ int StudentWorld::init() {
                 validPosition = false;
                 continue;
             }
-            bool hasEarth = true;
-            for (int i = x; i < x + 4 && i < 64; ++i) {
-                for (int j = y; j < y + 4 && j < 60; ++j) {
-                    if (m_earth[i][j] == nullptr) {
-                        hasEarth = false;
-                        break;
-                    }
-                }
-                if (!hasEarth)
-                    break;
-            }
-            if (!hasEarth) {
+            if (earthInRect(x, y, 4, 4) != 16) {
                 validPosition = false;
                 continue;
             }
@@ -118,9 +124,9 @@ int StudentWorld::init() {
                 }
             }
         } while (!validPosition);
-        GoldNugget* nugget = new GoldNugget(this, x, y, true, false, true);
+        GoldNugget* nugget = m_arena.create<GoldNugget>(this, x, y, true, false, true);
         nugget->setVisible(false);
-        m_everything.push_back(nugget);
+        addActor(nugget);
         objectPositions.push_back({x, y});
     }
     for (int i = 0; i < L; ++i) {
@@ -134,18 +140,7 @@ int StudentWorld::init() {
                 validPosition = false;
                 continue;
             }
-            bool hasEarth = true;
-            for (int i = x; i < x + 4 && i < 64; ++i) {
-                for (int j = y; j < y + 4 && j < 60; ++j) {
-                    if (m_earth[i][j] == nullptr) {
-                        hasEarth = false;
-                        break;
-                    }
-                }
-                if (!hasEarth)
-                    break;
-            }
-            if (!hasEarth) {
+            if (earthInRect(x, y, 4, 4) != 16) {
                 validPosition = false;
                 continue;
             }
@@ -157,38 +152,53 @@ int StudentWorld::init() {
                 }
             }
         } while (!validPosition);
-        Barrel* barrel = new Barrel(this, x, y);
+        Barrel* barrel = m_arena.create<Barrel>(this, x, y);
         barrel->setVisible(false);
-        m_everything.push_back(barrel);
+        addActor(barrel);
         objectPositions.push_back({x, y});
     }
+
+    // build every pooled actor now so that move() never has to
+    m_squirtPool->prewarm(this, 0, 0, GraphObject::right);
+    m_goldPool->prewarm(this, 0, 0, false, true, false);
+    m_waterPool->prewarm(this, 0, 0, 0);
+    m_sonarPool->prewarm(this, 0, 60, 0);
+    m_regularPool->prewarm(this);
+    m_hardcorePool->prewarm(this);
     return GWSTATUS_CONTINUE_GAME;
 }
 
 int StudentWorld::move() {
+    // every object a tick can need is created or reserved by init()
+    NoAllocationScope noAllocations;
     m_ticks++;
+    m_passStage = BEFORE_PASS;
+    m_timers.advance(m_ticks, [this](BaseForEverything* actor) { setAsleep(actor, false); });
     m_ticksSinceLastProtester++;
+    m_pathBudgetLeft = m_pathBudget;
 
     int T = std::max(25, 200 - static_cast<int>(getLevel()));
     int P = std::min(15, static_cast<int>(2 + getLevel() * 1.5));
 
-    if (m_ticksSinceLastProtester >= T &&
-        std::count_if(m_everything.begin(), m_everything.end(),
-                      [](BaseForEverything* actor) { return actor->isProtester() && actor->isAlive(); }) < P) {
+    if (m_ticksSinceLastProtester >= T && m_liveProtesters < P) {
 
         int probabilityOfHardcore = std::min(90, static_cast<int>(getLevel()) * 10 + 30);
         int randNum = rand() % 100;
 
         if (randNum < probabilityOfHardcore) {
-            HardcoreProtester* protester = new HardcoreProtester(this);
-            m_everything.push_back(protester);
+            HardcoreProtester* protester = m_hardcorePool->acquire(this);
+            if (protester == nullptr)
+                protester = m_arena.create<HardcoreProtester>(this);
+            addActor(protester);
         } else {
-            RegularProtester* protester = new RegularProtester(this);
-            m_everything.push_back(protester);
+            RegularProtester* protester = m_regularPool->acquire(this);
+            if (protester == nullptr)
+                protester = m_arena.create<RegularProtester>(this);
+            addActor(protester);
         }
 
         m_ticksSinceLastProtester = 0;
-                      }
+    }
 
     updateDisplayText();
     m_tunnelman->doSomething();
@@ -196,63 +206,117 @@ int StudentWorld::move() {
         decLives();
         return GWSTATUS_PLAYER_DIED;
     }
-    for (auto actor : m_everything) {
-        if (actor->isAlive()) {
-            actor->doSomething();
-            if (!m_tunnelman->isAlive()) {
-                decLives();
-                return GWSTATUS_PLAYER_DIED;
-            }
-            if (m_barrelsLeft == 0) {
-                playSound(SOUND_FINISHED_LEVEL);
-                return GWSTATUS_FINISHED_LEVEL;
-            }
-        }
-    }
+    // the Tunnelman's squirts join before the actors run, so they move
+    // on the tick they were fired
+    flushSpawns();
+    m_passStage = IN_PASS;
+    int status = m_updateOrder == UPDATE_BY_TYPE ? updateByType() : updateInterleaved();
+    m_passStage = AFTER_PASS;
+    if (status != GWSTATUS_CONTINUE_GAME)
+        return status;
+    flushSpawns();
     int G = getLevel() * 25 + 300;
     if (rand() % G == 0) {
         if (rand() % 5 == 0) {
-            SonarKit* sonar = new SonarKit(this, 0, 60, getLevel());
-            m_everything.push_back(sonar);
+            SonarKit* sonar = m_sonarPool->acquire(this, 0, 60, getLevel());
+            if (sonar == nullptr)
+                sonar = m_arena.create<SonarKit>(this, 0, 60, getLevel());
+            addActor(sonar);
         } else {
             int x, y;
-            bool found = false;
-            for (int i = 0; i < 100; ++i) {
-                x = rand() % 61;
-                y = rand() % 61;
-                bool areaClear = true;
-                for (int xx = x; xx < x + 4 && xx < 64; ++xx) {
-                    for (int yy = y; yy < y + 4 && yy < 60; ++yy) {
-                        if (isEarthAt(xx, yy)) {
-                            areaClear = false;
-                            break;
-                        }
-                    }
-                    if (!areaClear)
-                        break;
-                }
-                if (areaClear) {
-                    found = true;
-                    break;
-                }
-            }
+            bool found = findEarthFreeSpot(x, y);
             if (found) {
-                WaterPool* water = new WaterPool(this, x, y, getLevel());
-                m_everything.push_back(water);
+                WaterPool* water = m_waterPool->acquire(this, x, y, getLevel());
+                if (water == nullptr)
+                    water = m_arena.create<WaterPool>(this, x, y, getLevel());
+                addActor(water);
             }
         }
     }
 
-    auto it = m_everything.begin();
-    while (it != m_everything.end()) {
-        if (!(*it)->isAlive()) {
-            delete *it;
-            it = m_everything.erase(it);
-        } else {
-            ++it;
+    removeDeadActors();
+
+    if (!m_tunnelman->isAlive()) {
+        decLives();
+        return GWSTATUS_PLAYER_DIED;
+    }
+    if (m_barrelsLeft == 0) {
+        playSound(SOUND_FINISHED_LEVEL);
+        return GWSTATUS_FINISHED_LEVEL;
+    }
+    return GWSTATUS_CONTINUE_GAME;
+}
+
+int StudentWorld::updateInterleaved() {
+    for (std::size_t i = 0, n = m_actors.size(); i < n; ++i) {
+        if (m_actors.isAliveAt(i) && !m_actors.isAsleepAt(i)) {
+            m_passIndex = i;
+            m_actors.objectAt(i)->doSomething();
+            int status = tickOutcome();
+            if (status != GWSTATUS_CONTINUE_GAME)
+                return status;
         }
     }
+    return GWSTATUS_CONTINUE_GAME;
+}
+
+bool StudentWorld::isUpdatePending(const BaseForEverything* actor) const {
+    if (m_passStage != IN_PASS)
+        return m_passStage == BEFORE_PASS;
+    if (m_updateOrder == UPDATE_INTERLEAVED) {
+        std::size_t i = m_actors.positionOf(actor->getHandle());
+        return i < m_actors.size() && i > m_passIndex;
+    }
+    // actors spawned during the pass are not in m_actors yet
+    return m_actors.isValid(actor->getHandle()) && actor->getPassTick() != m_ticks;
+}
+
+int StudentWorld::nextUpdateTick(const BaseForEverything* actor) const {
+    return isUpdatePending(actor) ? m_ticks : m_ticks + 1;
+}
+
+// Calls T::doSomething() directly for every live actor of type imageID,
+// found by scanning the store's type array, stopping as soon as the tick
+// has to end. Every actor of that type is stamped with the tick as the pass
+// reaches it, asleep or not.
+template <typename T>
+int StudentWorld::updateBatch(int imageID) {
+    for (std::size_t i = 0, n = m_actors.size(); i < n; ++i) {
+        if (m_actors.typeAt(i) != imageID)
+            continue;
+        BaseForEverything* actor = m_actors.objectAt(i);
+        actor->setPassTick(m_ticks);
+        if (!m_actors.isAliveAt(i) || m_actors.isAsleepAt(i))
+            continue;
+        static_cast<T*>(actor)->T::doSomething();
+        int status = tickOutcome();
+        if (status != GWSTATUS_CONTINUE_GAME)
+            return status;
+    }
+    return GWSTATUS_CONTINUE_GAME;
+}
+
+int StudentWorld::updateByType() {
+    int status = updateBatch<Boulder>(TID_BOULDER);
+    if (status == GWSTATUS_CONTINUE_GAME)
+        status = updateBatch<Squirt>(TID_WATER_SPURT);
+    if (status == GWSTATUS_CONTINUE_GAME)
+        status = updateBatch<RegularProtester>(TID_PROTESTER);
+    if (status == GWSTATUS_CONTINUE_GAME)
+        status = updateBatch<HardcoreProtester>(TID_HARD_CORE_PROTESTER);
+    if (status == GWSTATUS_CONTINUE_GAME)
+        status = updateBatch<Barrel>(TID_BARREL);
+    if (status == GWSTATUS_CONTINUE_GAME)
+        status = updateBatch<GoldNugget>(TID_GOLD);
+    if (status == GWSTATUS_CONTINUE_GAME)
+        status = updateBatch<SonarKit>(TID_SONAR);
+    if (status == GWSTATUS_CONTINUE_GAME)
+        status = updateBatch<WaterPool>(TID_WATER_POOL);
+    return status;
+}
 
+// Ends the tick if the Tunnelman has died or the last barrel was found.
+int StudentWorld::tickOutcome() {
     if (!m_tunnelman->isAlive()) {
         decLives();
         return GWSTATUS_PLAYER_DIED;
@@ -273,32 +337,62 @@ void StudentWorld::updateDisplayText() {
     int gold = m_tunnelman->getGoldCount();
     int sonar = m_tunnelman->getSonarChargeCount();
     int barrelsLeft = m_barrelsLeft;
-    std::ostringstream oss;
-    oss.setf(std::ios::fixed);
-    oss << "Lvl: " << std::setw(2) << level << "  "
-        << "Lives: " << lives << "  "
-        << "Hlth: " << setw(3) << health << "%  "
-        << "Wtr: " << setw(2) << squirts << "  "
-        << "Gld: " << setw(2) << gold << "  "
-        << "Oil Left: " << setw(2) << barrelsLeft << "  "
-        << "Sonar: " << setw(2) << sonar << "  "
-        << "Scr: " << setfill('0') << setw(6) << score;
-    setGameStatText(oss.str());
+    // formatted into a fixed buffer and copied into a string that keeps its
+    // capacity, so refreshing the status line every tick does not allocate
+    char text[128];
+    std::snprintf(text, sizeof(text),
+                  "Lvl: %2d  Lives: %d  Hlth: %3d%%  Wtr: %2d  Gld: %2d  Oil Left: %2d  Sonar: %2d  Scr: %06d",
+                  level, lives, health, squirts, gold, barrelsLeft, sonar, score);
+    m_statText.assign(text);
+    setGameStatText(m_statText);
 }
 
+// Everything a level creates lives in m_arena, so nothing is destroyed one
+// by one here: the renderer forgets all objects and the arena is rewound.
 void StudentWorld::cleanUp() {
-    delete m_tunnelman;
     m_tunnelman = nullptr;
-    for (auto actor : m_everything) {
-        delete actor;
+    m_squirtPool = nullptr;
+    m_goldPool = nullptr;
+    m_waterPool = nullptr;
+    m_sonarPool = nullptr;
+    m_regularPool = nullptr;
+    m_hardcorePool = nullptr;
+    m_actors.clear();
+    m_spawnQueue.clear();
+    m_protesters.clear();
+    m_boulders.clear();
+    m_pickups.clear();
+    m_projectiles.clear();
+    m_liveProtesters = 0;
+    m_actorGrid.clear();
+    m_timers.clear(0);
+    GraphObject::clearGraphObjects();
+    m_arena.reset();
+    clearTerrain();
+}
+
+void StudentWorld::clearTerrain() {
+    for (int y = 0; y < 60; ++y) {
+        m_earthRows[y] = 0;
+        m_supportRows[y] = 0;
     }
-    m_everything.clear();
     for (int x = 0; x < 64; ++x) {
-        for (int y = 0; y < 60; ++y) {
-            delete m_earth[x][y];
-            m_earth[x][y] = nullptr;
-        }
+        m_earthCols[x] = 0;
+        m_boulderCols[x] = 0;
+    }
+    for (int y = 0; y < 64; ++y) {
+        m_boulderRows[y] = 0;
+        m_boulderOriginRows[y] = 0;
+        for (int x = 0; x < 64; ++x)
+            m_boulderCount[x][y] = 0;
     }
+    for (int y = 0; y <= 60; ++y)
+        m_openRows[y] = 0;
+    m_terrainVersion++;
+    for (int r = 0; r < 64; ++r)
+        m_regionChangedAt[r] = m_terrainVersion;
+    m_exitField.invalidate();
+    m_tunnelmanField.invalidate();
 }
 GameWorld* createStudentWorld(string assetDir)
 {
@@ -306,69 +400,396 @@ GameWorld* createStudentWorld(string assetDir)
 }
 
 bool StudentWorld::removeEarth(int x, int y) {
-    if (x < 0 || x >= 64 || y < 0 || y >= 60)
+    if (!isEarthAt(x, y))
         return false;
-    if (m_earth[x][y]) {
-        delete m_earth[x][y];
-        m_earth[x][y] = nullptr;
-        return true;
+    clearEarthBits(y, 1ULL << x);
+    updateOpenRows(y, y);
+    return true;
+}
+
+bool StudentWorld::digEarth(int x, int y) {
+    if (x < 0 || x >= 64)
+        return false;
+    const std::uint64_t mask = 0xFULL << x;
+    bool removed = false;
+    for (int j = std::max(y, 0); j < y + 4 && j < 60; ++j) {
+        if (m_earthRows[j] & mask) {
+            clearEarthBits(j, mask);
+            removed = true;
+        }
+    }
+    if (removed)
+        updateOpenRows(y, y + 3);
+    return removed;
+}
+
+void StudentWorld::clearEarthBits(int y, std::uint64_t cells) {
+    cells &= m_earthRows[y];
+    m_earthRows[y] &= ~cells;
+    if (cells & m_supportRows[y])
+        wakeBoulders(y, cells & m_supportRows[y]);
+    for (int x = 0; cells != 0; ++x, cells >>= 1) {
+        if (cells & 1)
+            m_earthCols[x] &= ~(1ULL << y);
+    }
+}
+
+void StudentWorld::setAsleep(BaseForEverything* actor, bool asleep) {
+    m_actors.setAsleep(actor->getHandle(), asleep);
+}
+
+void StudentWorld::sleepUntil(BaseForEverything* actor, int tick) {
+    if (tick <= nextUpdateTick(actor)) {
+        m_timers.cancel(actor->getTimer());
+        setAsleep(actor, false);
+        return;
+    }
+    setAsleep(actor, true);
+    m_timers.schedule(actor->getTimer(), tick);
+}
+
+void StudentWorld::sleepBoulder(Boulder* boulder) {
+    int y = boulder->getY() - 1;
+    if (y < 0 || y >= 60)
+        return;
+    setAsleep(boulder, true);
+    m_supportRows[y] |= 0xFULL << boulder->getX();
+}
+
+// Wakes every sleeping boulder resting on one of cells in row y; a woken
+// boulder that is still supported goes back to sleep on its next update.
+void StudentWorld::wakeBoulders(int y, std::uint64_t cells) {
+    std::uint64_t stillAsleep = 0;
+    for (std::size_t i = 0, n = m_actors.size(); i < n; ++i) {
+        if (m_actors.typeAt(i) != TID_BOULDER || m_actors.yAt(i) - 1 != y || !m_actors.isAsleepAt(i))
+            continue;
+        std::uint64_t support = 0xFULL << m_actors.xAt(i);
+        if (support & cells)
+            m_actors.setAsleepAt(i, false);
+        else
+            stillAsleep |= support;
+    }
+    m_supportRows[y] = stillAsleep;
+}
+
+static int popCount(std::uint64_t bits) {
+    return static_cast<int>(std::bitset<64>(bits).count());
+}
+
+int StudentWorld::earthInRect(int x, int y, int width, int height) const {
+    int from = std::max(x, 0);
+    int to = std::min(x + width, 64);
+    if (from >= to)
+        return 0;
+    std::uint64_t span = (to == 64 ? ~0ULL : (1ULL << to) - 1) & ~((1ULL << from) - 1);
+    int count = 0;
+    for (int j = std::max(y, 0); j < y + height && j < 60; ++j)
+        count += popCount(m_earthRows[j] & span);
+    return count;
+}
+
+// Behaves like making up to 100 random probes of the 61x61 spots for one
+// whose 4x4 square holds no Earth: it fails with the chance that all 100
+// probes would miss, and otherwise picks uniformly among the free spots.
+bool StudentWorld::findEarthFreeSpot(int& x, int& y) const {
+    std::uint64_t freeRows[61];
+    int total = 0;
+    for (int row = 0; row <= 60; ++row) {
+        std::uint64_t covered = 0;
+        for (int j = row; j < row + 4 && j < 60; ++j)
+            covered |= m_earthRows[j] | (m_earthRows[j] >> 1) | (m_earthRows[j] >> 2) | (m_earthRows[j] >> 3);
+        freeRows[row] = ~covered & ((1ULL << 61) - 1);
+        total += popCount(freeRows[row]);
+    }
+    if (total == 0)
+        return false;
+    double allMiss = std::pow(1.0 - total / (61.0 * 61.0), 100);
+    if (rand() / (RAND_MAX + 1.0) < allMiss)
+        return false;
+
+    int pick = rand() % total;
+    for (y = 0; pick >= popCount(freeRows[y]); ++y)
+        pick -= popCount(freeRows[y]);
+    for (x = 0; ; ++x) {
+        if (((freeRows[y] >> x) & 1) && pick-- == 0)
+            return true;
     }
-    return false;
 }
 
 bool StudentWorld::isEarthAt(int x, int y) const {
     if (x < 0 || x >= 64 || y < 0 || y >= 60)
         return false;
-    return m_earth[x][y] != nullptr;
+    return (m_earthRows[y] >> x) & 1;
+}
+
+const std::uint64_t* StudentWorld::getEarthRows(int& numRows) const {
+    numRows = 60;
+    return m_earthRows;
 }
 
 bool StudentWorld::isBoulderAt(int x, int y) const {
-    for (auto actor : m_everything) {
-        if (actor->getID() == TID_BOULDER) {
-            if (actor->getX() == x && actor->getY() == y)
-                return true;
-        }
-    }
-    return false;
+    if (x < 0 || x >= 64 || y < 0 || y >= 64)
+        return false;
+    return (m_boulderOriginRows[y] >> x) & 1;
 }
 
 bool StudentWorld::isBlocked(int x, int y) const {
-    if (isEarthAt(x, y))
+    if (x < 0 || x >= 64 || y < 0 || y >= 64)
+        return false;
+    if (y < 60 && ((m_earthRows[y] >> x) & 1))
         return true;
-    for (auto actor : m_everything) {
-        if (actor->getID() == TID_BOULDER) {
-            if (actor->getX() <= x && x < actor->getX() + 4 &&
-                actor->getY() <= y && y < actor->getY() + 4)
-                return true;
+    return (m_boulderRows[y] >> x) & 1;
+}
+
+void StudentWorld::addBoulder(int x, int y) {
+    markBoulder(x, y, 1);
+}
+
+void StudentWorld::removeBoulder(int x, int y) {
+    markBoulder(x, y, -1);
+}
+
+void StudentWorld::markBoulder(int x, int y, int delta) {
+    if (x >= 0 && x < 64 && y >= 0 && y < 64) {
+        if (delta > 0)
+            m_boulderOriginRows[y] |= 1ULL << x;
+        else
+            m_boulderOriginRows[y] &= ~(1ULL << x);
+    }
+    for (int i = std::max(x, 0); i < x + 4 && i < 64; ++i) {
+        for (int j = std::max(y, 0); j < y + 4 && j < 64; ++j) {
+            m_boulderCount[i][j] += delta;
+            if (m_boulderCount[i][j] != 0) {
+                m_boulderRows[j] |= 1ULL << i;
+                m_boulderCols[i] |= 1ULL << j;
+            } else {
+                m_boulderRows[j] &= ~(1ULL << i);
+                m_boulderCols[i] &= ~(1ULL << j);
+            }
         }
     }
-    return false;
+    updateOpenRows(y, y + 3);
 }
 
-bool StudentWorld::isBoulderNearby(int x, int y, double radius) const {
-    for (auto actor : m_everything) {
-        if (actor->getID() == TID_BOULDER) {
-            double dist = sqrt(pow(actor->getX() - x, 2) + pow(actor->getY() - y, 2));
-            if (dist <= radius)
-                return true;
+static std::uint64_t spanMask(int from, int to) {
+    from = std::max(from, 0);
+    to = std::min(to, 64);
+    if (from >= to)
+        return 0;
+    std::uint64_t below = to == 64 ? ~0ULL : (1ULL << to) - 1;
+    return below & ~((1ULL << from) - 1);
+}
+
+bool StudentWorld::isRowSpanClear(int y, int xFrom, int xTo) const {
+    if (y < 0 || y >= 64)
+        return true;
+    std::uint64_t blocked = m_boulderRows[y] | (y < 60 ? m_earthRows[y] : 0);
+    return (blocked & spanMask(xFrom, xTo)) == 0;
+}
+
+bool StudentWorld::isColumnSpanClear(int x, int yFrom, int yTo) const {
+    if (x < 0 || x >= 64)
+        return true;
+    return ((m_earthCols[x] | m_boulderCols[x]) & spanMask(yFrom, yTo)) == 0;
+}
+
+bool StudentWorld::canStandAt(int x, int y) const {
+    if (x < 0 || x > 60 || y < 0 || y > 60)
+        return false;
+    return (m_openRows[y] >> x) & 1;
+}
+
+void StudentWorld::updateOpenRows(int yFrom, int yTo) {
+    const std::uint64_t inBounds = (1ULL << 61) - 1;
+    for (int y = std::max(yFrom - 3, 0); y <= yTo && y <= 60; ++y) {
+        std::uint64_t covered = 0;
+        for (int j = y; j < y + 4; ++j) {
+            std::uint64_t blocked = m_boulderRows[j] | (j < 60 ? m_earthRows[j] : 0);
+            covered |= blocked | (blocked >> 1) | (blocked >> 2) | (blocked >> 3);
+        }
+        std::uint64_t open = ~covered & inBounds;
+        std::uint64_t changed = open ^ m_openRows[y];
+        if (changed == 0)
+            continue;
+        m_exitField.markChanged(y, changed);
+        m_tunnelmanField.markChanged(y, changed);
+        m_openRows[y] = open;
+        m_terrainVersion++;
+        for (int x = 0; changed != 0; x += PathCache::REGION_SIZE, changed >>= PathCache::REGION_SIZE) {
+            if (changed & ((1ULL << PathCache::REGION_SIZE) - 1))
+                m_regionChangedAt[PathCache::regionOf(x, y)] = m_terrainVersion;
         }
     }
-    return false;
+}
+
+bool StudentWorld::isTerrainUnchangedSince(std::uint64_t regions, std::uint32_t version) const {
+    for (int r = 0; regions != 0; ++r, regions >>= 1) {
+        if ((regions & 1) && m_regionChangedAt[r] > version)
+            return false;
+    }
+    return true;
+}
+
+const DistanceField& StudentWorld::getExitField() {
+    return refreshField(m_exitField, m_exitFieldTick, 60, 60);
+}
+
+const DistanceField& StudentWorld::getTunnelmanField() {
+    return refreshField(m_tunnelmanField, m_tunnelmanFieldTick, m_tunnelman->getX(), m_tunnelman->getY());
+}
+
+// Brings field up to date for a root at (rootX, rootY), at most once per
+// tick. Under a budget a rebuild that does not fit is left unsettled and
+// picked up again by later calls, keeping the root it started with.
+const DistanceField& StudentWorld::refreshField(DistanceField& field, int& fieldTick, int rootX, int rootY) {
+    if (fieldTick == m_ticks)
+        return field;
+    if (field.isSettled()) {
+        // out of budget: the last result stands until a later tick
+        if (m_pathBudget != 0 && m_pathBudgetLeft <= 0)
+            return field;
+        if (!field.isRootedAt(rootX, rootY))
+            field.beginCompute(rootX, rootY);
+        else if (field.hasChanges())
+            m_pathBudgetLeft -= field.beginRepair(m_openRows);
+        else
+            return field;
+    }
+    if (m_pathBudget == 0)
+        field.advance(m_openRows, INT_MAX);
+    else if (m_pathBudgetLeft > 0)
+        m_pathBudgetLeft -= field.advance(m_openRows, m_pathBudgetLeft);
+    if (field.isSettled())
+        fieldTick = m_ticks;
+    return field;
+}
+
+bool StudentWorld::isBoulderNearby(int x, int y, double radius) const {
+    bool found = false;
+    queryRadius(x, y, radius, typeBit(TID_BOULDER), [&](BaseForEverything*) {
+        found = true;
+        return false;
+    });
+    return found;
 }
 
 void StudentWorld::addActor(BaseForEverything* actor) {
-    m_everything.push_back(actor);
+    actor->setHandle(m_actors.add(actor, actor->getX(), actor->getY(), actor->getID()));
+    switch (actor->getID()) {
+        case TID_PROTESTER:
+        case TID_HARD_CORE_PROTESTER:
+            m_protesters.push_back(static_cast<Protester*>(actor));
+            m_liveProtesters++;
+            break;
+        case TID_BOULDER:
+            m_boulders.push_back(static_cast<Boulder*>(actor));
+            break;
+        case TID_WATER_SPURT:
+            m_projectiles.push_back(static_cast<Squirt*>(actor));
+            break;
+        default:
+            m_pickups.push_back(actor);
+            break;
+    }
+    m_actorGrid.insert(actor->getHandle(), actor->getX(), actor->getY());
+    // a protester appearing next to dropped gold counts as moving there
+    if (actor->isProtester())
+        triggerPickups(actor->getX(), actor->getY(), 3.0, typeBit(TID_GOLD));
 }
 
-void StudentWorld::revealHiddenObjects(int x, int y, double radius) {
-    for (auto actor : m_everything) {
-        if (!actor->isVisible()) {
-            double dist = sqrt(pow(actor->getX() - x, 2) + pow(actor->getY() - y, 2));
-            if (dist <= radius)
-                actor->setVisible(true);
-        }
+void StudentWorld::spawnSquirt(int x, int y, GraphObject::Direction dir) {
+    Squirt* squirt = m_squirtPool->acquire(this, x, y, dir);
+    if (squirt == nullptr)
+        squirt = m_arena.create<Squirt>(this, x, y, dir);
+    m_spawnQueue.push_back(squirt);
+}
+
+void StudentWorld::spawnDroppedGold(int x, int y) {
+    GoldNugget* gold = m_goldPool->acquire(this, x, y, true, true, false);
+    if (gold == nullptr)
+        gold = m_arena.create<GoldNugget>(this, x, y, true, true, false);
+    m_spawnQueue.push_back(gold);
+}
+
+void StudentWorld::flushSpawns() {
+    for (BaseForEverything* actor : m_spawnQueue)
+        addActor(actor);
+    m_spawnQueue.clear();
+}
+
+void StudentWorld::onActorMoved(BaseForEverything* actor, int oldX, int oldY, int newX, int newY) {
+    if (actor == m_tunnelman) {
+        triggerPickups(newX, newY, 4.0, pickupTypes());
+        return;
     }
+    m_actors.setPosition(actor->getHandle(), newX, newY);
+    m_actorGrid.move(actor->getHandle(), oldX, oldY, newX, newY);
+    if (actor->isProtester())
+        triggerPickups(newX, newY, 3.0, typeBit(TID_GOLD));
 }
+
+// Wakes the pickups of a type in typeMask within radius of (x, y) and has
+// them check their surroundings on their next update.
+void StudentWorld::triggerPickups(int x, int y, double radius, unsigned typeMask) {
+    queryRadius(x, y, radius, typeMask, [this](BaseForEverything* actor) {
+        static_cast<Pickup*>(actor)->trigger();
+        setAsleep(actor, false);
+        return true;
+    });
+}
+
+void StudentWorld::onActorDied(BaseForEverything* actor) {
+    m_actors.markDead(actor->getHandle());
+    if (actor->isProtester())
+        m_liveProtesters--;
+    m_actorGrid.remove(actor->getHandle(), actor->getX(), actor->getY());
+    m_timers.cancel(actor->getTimer());
+}
+
+template <typename T>
+static void eraseDead(std::vector<T*>& actors) {
+    actors.erase(std::remove_if(actors.begin(), actors.end(),
+                                [](T* actor) { return !actor->isAlive(); }),
+                 actors.end());
+}
+
+void StudentWorld::removeDeadActors() {
+    eraseDead(m_protesters);
+    eraseDead(m_boulders);
+    eraseDead(m_pickups);
+    eraseDead(m_projectiles);
+
+    m_actors.removeDead([this](BaseForEverything* actor) { destroyActor(actor); });
+}
+
+void StudentWorld::destroyActor(BaseForEverything* actor) {
+    if (m_squirtPool->owns(actor))
+        m_squirtPool->release(static_cast<Squirt*>(actor));
+    else if (m_goldPool->owns(actor))
+        m_goldPool->release(static_cast<GoldNugget*>(actor));
+    else if (m_waterPool->owns(actor))
+        m_waterPool->release(static_cast<WaterPool*>(actor));
+    else if (m_sonarPool->owns(actor))
+        m_sonarPool->release(static_cast<SonarKit*>(actor));
+    else if (m_regularPool->owns(actor))
+        m_regularPool->release(static_cast<RegularProtester*>(actor));
+    else if (m_hardcorePool->owns(actor))
+        m_hardcorePool->release(static_cast<HardcoreProtester*>(actor));
+    else
+        actor->~BaseForEverything();
+}
+
+void StudentWorld::revealHiddenObjects(int x, int y, double radius) {
+    queryRadius(x, y, radius, ~0u, [](BaseForEverything* actor) {
+        if (!actor->isVisible())
+            actor->setVisible(true);
+        return true;
+    });
+}
+bool StudentWorld::isBeyondDetailRadius(int x, int y) const {
+    return m_detailRadius > 0 && distanceToTunnelman(x, y) > m_detailRadius;
+}
+
 double StudentWorld::distanceToTunnelman(int x, int y) const {
     int tunnelmanX = m_tunnelman->getX();
     int tunnelmanY = m_tunnelman->getY();
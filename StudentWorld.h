@@ -2,12 +2,30 @@
 #define STUDENTWORLD_H_
 
 #include "GameWorld.h"
+#include "GraphObject.h"
+#include "DistanceField.h"
+#include "EntityStore.h"
+#include "LevelArena.h"
+#include "SpatialGrid.h"
+#include "TimerWheel.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 class BaseForEverything;
 class Tunnelman;
-class Earth;
+class Protester;
+class Boulder;
+class Squirt;
+class GoldNugget;
+class Barrel;
+class WaterPool;
+class SonarKit;
+class RegularProtester;
+class HardcoreProtester;
+template <typename T, int N> class ActorPool;
 
 class StudentWorld : public GameWorld {
 public:
@@ -23,24 +41,187 @@ public:
     virtual void cleanUp();
 
     bool removeEarth(int x, int y);
+    bool digEarth(int x, int y);
     bool isEarthAt(int x, int y) const;
+    int earthInRect(int x, int y, int width, int height) const;
     bool isBoulderAt(int x, int y) const;
     bool isBlocked(int x, int y) const;
+    bool canStandAt(int x, int y) const;
+    // true if no cell in [from, to) along the row or column is blocked
+    bool isRowSpanClear(int y, int xFrom, int xTo) const;
+    bool isColumnSpanClear(int x, int yFrom, int yTo) const;
+    // Either field may still be rebuilding when the tick's pathfinding
+    // budget has run out; it then answers from its last settled result,
+    // which for the Tunnelman field may be rooted where the Tunnelman was.
+    const DistanceField& getExitField();
+    const DistanceField& getTunnelmanField();
+    // Caps the positions the distance fields may expand per tick, so that a
+    // rebuild is spread over several ticks instead of stalling one. 0 (the
+    // default) means no cap.
+    void setPathfindingBudget(int nodesPerTick) { m_pathBudget = std::max(nodesPerTick, 0); }
+    // Lets protesters replay the route they last took from a distance field
+    // until the target moves or the terrain changes somewhere a shorter or
+    // tied route could pass. On by default. Without a pathfinding budget,
+    // protesters move exactly as they would without it; with one, a replayed
+    // route can be newer than the field they would otherwise read.
+    void setPathCaching(bool enabled) { m_pathCaching = enabled; }
+    bool isPathCaching() const { return m_pathCaching; }
+    // bumped by every change to where actors can stand
+    std::uint32_t getTerrainVersion() const { return m_terrainVersion; }
+    // true if no PathCache region in regions has changed after version
+    bool isTerrainUnchangedSince(std::uint64_t regions, std::uint32_t version) const;
     bool isBoulderNearby(int x, int y, double radius) const;
+    void addBoulder(int x, int y);
+    // A sleeping boulder is skipped by move() until Earth in the row just
+    // below it is removed.
+    void sleepBoulder(Boulder* boulder);
+    void removeBoulder(int x, int y);
+    // Interleaved runs actors in the order they were added; by-type runs
+    // each kind of actor in its own loop (boulders, squirts, regular and
+    // hardcore protesters, then barrels, gold, sonar and water).
+    enum UpdateOrder { UPDATE_INTERLEAVED, UPDATE_BY_TYPE };
+    void setUpdateOrder(UpdateOrder order) { m_updateOrder = order; }
+    // Hardcore protesters farther than radius from the Tunnelman skip
+    // pathfinding to the Tunnelman and carry on as if it were out of reach.
+    // 0 (the default) turns this off; otherwise the radius is never less
+    // than shouting range.
+    void setProtesterDetailRadius(double radius) { m_detailRadius = radius > 0 ? std::max(radius, 4.0) : 0; }
+    bool isBeyondDetailRadius(int x, int y) const;
+
     void addActor(BaseForEverything* actor);
+    // actors spawned from doSomething() are queued and only join the world
+    // once the current update pass is over
+    void spawnSquirt(int x, int y, GraphObject::Direction dir);
+    void spawnDroppedGold(int x, int y);
+    void onActorMoved(BaseForEverything* actor, int oldX, int oldY, int newX, int newY);
+    // A sleeping actor is skipped by move() until something wakes it.
+    void setAsleep(BaseForEverything* actor, bool asleep);
+    // Keeps actor asleep until tick (or wakes it now, if it would next be
+    // updated at or after tick anyway).
+    void sleepUntil(BaseForEverything* actor, int tick);
+    int getTick() const { return m_ticks; }
+    // storage for an actor's behaviour coroutine; lives until the level ends
+    void* allocateFrame(std::size_t size) { return m_arena.allocate(size, alignof(std::max_align_t)); }
+    // the tick of actor's next update: this one if the update pass has yet
+    // to reach it, otherwise the next
+    int nextUpdateTick(const BaseForEverything* actor) const;
+    void onActorDied(BaseForEverything* actor);
     void revealHiddenObjects(int x, int y, double radius);
     bool annoyProtestersAt(int x, int y, double radius, int amount);
     void decrementBarrels() { m_barrelsLeft--; }
     Tunnelman* getTunnelman() const { return m_tunnelman; }
-    const std::vector<BaseForEverything*>& getActors() const { return m_everything; }
+    const std::vector<BaseForEverything*>& getActors() const { return m_actors.objects(); }
+    // nullptr once the actor handle refers to has been removed, even if its
+    // object has since been reused from a pool
+    BaseForEverything* getActor(ActorHandle handle) const { return m_actors.get(handle); }
+    const std::vector<Protester*>& getProtesters() const { return m_protesters; }
+    const std::vector<Boulder*>& getBoulders() const { return m_boulders; }
+    const std::vector<BaseForEverything*>& getPickups() const { return m_pickups; }
+    const std::vector<Squirt*>& getProjectiles() const { return m_projectiles; }
+    int getLiveProtesterCount() const { return m_liveProtesters; }
     double distanceToTunnelman(int x, int y) const;
+    virtual const std::uint64_t* getEarthRows(int& numRows) const;
+
+    static unsigned typeBit(int imageID) { return SpatialGrid<ActorHandle>::typeBit(imageID); }
+    static unsigned protesterTypes() { return typeBit(TID_PROTESTER) | typeBit(TID_HARD_CORE_PROTESTER); }
+    static unsigned pickupTypes() {
+        return typeBit(TID_BARREL) | typeBit(TID_GOLD) | typeBit(TID_SONAR) | typeBit(TID_WATER_POOL);
+    }
 
+    // visit(actor) is called for each live actor of a type in typeMask within
+    // radius of (x, y); returning false from visit ends the query
+    template <typename Visitor>
+    void queryRadius(int x, int y, double radius, unsigned typeMask, Visitor visit) const {
+        double radiusSq = radius * radius;
+        m_actorGrid.forEachNear(x, y, radius, [&](ActorHandle handle) {
+            std::size_t i = m_actors.positionOf(handle);
+            if (!(typeBit(m_actors.typeAt(i)) & typeMask))
+                return true;
+            int dx = m_actors.xAt(i) - x;
+            int dy = m_actors.yAt(i) - y;
+            return dx * dx + dy * dy > radiusSq || visit(m_actors.objectAt(i));
+        });
+    }
 
 private:
     void updateDisplayText();
+    int updateInterleaved();
+    int updateByType();
+    template <typename T>
+    int updateBatch(int imageID);
+    int tickOutcome();
+    bool isUpdatePending(const BaseForEverything* actor) const;
+    void clearTerrain();
+    const DistanceField& refreshField(DistanceField& field, int& fieldTick, int rootX, int rootY);
+    void markBoulder(int x, int y, int delta);
+    void clearEarthBits(int y, std::uint64_t cells);
+    void wakeBoulders(int y, std::uint64_t cells);
+    void triggerPickups(int x, int y, double radius, unsigned typeMask);
+    bool findEarthFreeSpot(int& x, int& y) const;
+    void updateOpenRows(int yFrom, int yTo);
+    void flushSpawns();
+    void removeDeadActors();
+    void destroyActor(BaseForEverything* actor);
     Tunnelman* m_tunnelman;
-    std::vector<BaseForEverything*> m_everything;
-    Earth* m_earth[64][60];
+    EntityStore<BaseForEverything> m_actors;
+    // typed views of m_actors; an actor is in exactly one of these
+    std::vector<Protester*> m_protesters;
+    std::vector<Boulder*> m_boulders;
+    std::vector<BaseForEverything*> m_pickups;
+    std::vector<Squirt*> m_projectiles;
+    int m_liveProtesters;
+    std::vector<BaseForEverything*> m_spawnQueue;
+    std::string m_statText;
+    // owns the Tunnelman, every actor and the pools below for one level
+    LevelArena m_arena;
+    // short-lived actors are recycled rather than reallocated; when a pool
+    // is exhausted the spawn falls back to the arena
+    ActorPool<Squirt, 16>* m_squirtPool;
+    ActorPool<GoldNugget, 16>* m_goldPool;
+    ActorPool<WaterPool, 8>* m_waterPool;
+    ActorPool<SonarKit, 4>* m_sonarPool;
+    ActorPool<RegularProtester, 16>* m_regularPool;
+    ActorPool<HardcoreProtester, 16>* m_hardcorePool;
+    // holds the handle of every live actor in m_actors
+    SpatialGrid<ActorHandle> m_actorGrid;
+    UpdateOrder m_updateOrder;
+    double m_detailRadius;
+    // where this tick's update pass has got to, for nextUpdateTick()
+    enum PassStage { BEFORE_PASS, IN_PASS, AFTER_PASS };
+    PassStage m_passStage;
+    // interleaved order only; by-type order stamps each actor it reaches
+    std::size_t m_passIndex;
+    TimerWheel<BaseForEverything> m_timers;
+    // bit x of m_earthRows[y] is set while (x, y) holds Earth
+    std::uint64_t m_earthRows[60];
+    // transposed copies of the Earth and boulder masks: bit y of column x
+    std::uint64_t m_earthCols[64];
+    std::uint64_t m_boulderCols[64];
+    // boulder footprints may overlap while one is falling, so each cell keeps
+    // a count; the row masks mirror which counts are non-zero
+    unsigned char m_boulderCount[64][64];
+    std::uint64_t m_boulderRows[64];
+    std::uint64_t m_boulderOriginRows[64];
+    // bit x of m_supportRows[y] is set if (x, y) is under a sleeping boulder
+    std::uint64_t m_supportRows[60];
+    // bit x of m_openRows[y] is set if a 4x4 actor can stand with its
+    // lower-left corner at (x, y) without overlapping Earth or a boulder
+    std::uint64_t m_openRows[61];
+
+    // shared by every leaving protester; repaired at most once per tick, and
+    // only around positions whose walkability has changed
+    DistanceField m_exitField;
+    int m_exitFieldTick;
+    // shared by every hardcore protester; rebuilt when the Tunnelman moves
+    DistanceField m_tunnelmanField;
+    int m_tunnelmanFieldTick;
+    // what is left of this tick's pathfinding budget
+    int m_pathBudget;
+    int m_pathBudgetLeft;
+    bool m_pathCaching;
+    std::uint32_t m_terrainVersion;
+    // terrain version of the last change in each PathCache region
+    std::uint32_t m_regionChangedAt[64];
     int m_ticks;
     int m_barrelsLeft;
 
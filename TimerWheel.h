@@ -0,0 +1,114 @@
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+// A node is embedded in each object that can be scheduled, so scheduling
+// and cancelling never allocate.
+template <typename T>
+struct TimerNode {
+    TimerNode() : prev(nullptr), next(nullptr), due(0), owner(nullptr) {}
+
+    bool isScheduled() const { return next != nullptr; }
+
+    TimerNode* prev;
+    TimerNode* next;
+    long due;
+    T* owner;
+};
+
+// Hierarchical timing wheel keyed by tick number. Level 0 has one slot per
+// tick for the next 64 ticks; each higher level covers 64 times as many
+// ticks per slot, and its nodes are moved down a level when their slot
+// comes up. Scheduling, cancelling and firing are all constant time.
+template <typename T>
+class TimerWheel {
+public:
+    TimerWheel() : m_now(0) {
+        clear(0);
+    }
+
+    // Empties every slot and restarts the wheel at tick now. Nodes that
+    // were scheduled keep their stale links.
+    void clear(long now) {
+        m_now = now;
+        for (int level = 0; level < LEVELS; ++level) {
+            for (int slot = 0; slot < SLOTS; ++slot) {
+                TimerNode<T>& head = m_slots[level][slot];
+                head.prev = head.next = &head;
+            }
+        }
+    }
+
+    // Fires node on the first advance() that reaches tick due (or the next
+    // one, if due has already passed). A node that is already scheduled is
+    // moved.
+    void schedule(TimerNode<T>& node, long due) {
+        cancel(node);
+        node.due = due > m_now ? due : m_now + 1;
+        insert(node);
+    }
+
+    void cancel(TimerNode<T>& node) {
+        if (!node.isScheduled())
+            return;
+        node.prev->next = node.next;
+        node.next->prev = node.prev;
+        node.prev = node.next = nullptr;
+    }
+
+    // Steps the wheel forward to tick now, calling fire(owner) for each
+    // node that comes due, in tick order.
+    template <typename Fire>
+    void advance(long now, Fire fire) {
+        while (m_now < now) {
+            ++m_now;
+            int top = 0;
+            while (top + 1 < LEVELS && (m_now & ((1L << (BITS * (top + 1))) - 1)) == 0)
+                ++top;
+            for (int level = top; level >= 1; --level)
+                cascade(m_slots[level][slotOf(m_now, level)]);
+
+            TimerNode<T>& head = m_slots[0][slotOf(m_now, 0)];
+            while (head.next != &head) {
+                TimerNode<T>& node = *head.next;
+                cancel(node);
+                fire(node.owner);
+            }
+        }
+    }
+
+private:
+    static const int BITS = 6;
+    static const int SLOTS = 1 << BITS;
+    static const int LEVELS = 4;
+
+    static int slotOf(long tick, int level) {
+        return static_cast<int>((tick >> (BITS * level)) & (SLOTS - 1));
+    }
+
+    void insert(TimerNode<T>& node) {
+        // the lowest level on which due and now share their upper bits
+        int level = 0;
+        while (level + 1 < LEVELS && (node.due >> (BITS * (level + 1))) != (m_now >> (BITS * (level + 1))))
+            ++level;
+        TimerNode<T>& head = m_slots[level][slotOf(node.due, level)];
+        node.prev = head.prev;
+        node.next = &head;
+        head.prev->next = &node;
+        head.prev = &node;
+    }
+
+    void cascade(TimerNode<T>& head) {
+        TimerNode<T>* node = head.next;
+        head.prev = head.next = &head;
+        while (node != &head) {
+            TimerNode<T>* next = node->next;
+            insert(*node);
+            node = next;
+        }
+    }
+
+    TimerNode<T> m_slots[LEVELS][SLOTS];
+    long m_now;
+};
+
+#endif // TIMERWHEEL_H_
@@ -0,0 +1,51 @@
+// Plays scripted levels with TUNNELMAN_COUNT_ALLOCATIONS on and checks that
+// StudentWorld::move() never allocates. The check is made here rather than
+// left to NoAllocationScope's assert so that it also holds in builds that
+// define NDEBUG.
+
+#include "AllocationCounter.h"
+#include "GameConstants.h"
+#include "StudentWorld.h"
+#include <cstdio>
+#include <cstdlib>
+
+GameWorld* createStudentWorld(std::string assetDir);
+void seedHeadlessKeys(unsigned seed);
+bool continueHeadless(GameWorld* world, int status);
+
+namespace {
+    const int RUNS = 40;
+    const int TICKS_PER_RUN = 3000;
+
+    bool playRun(int run) {
+        srand(run + 1);
+        seedHeadlessKeys(run + 1);
+        GameWorld* world = createStudentWorld("");
+        // later runs start on later levels, which have more protesters
+        for (int level = 0; level < run % 8; ++level)
+            world->advanceToNextLevel();
+        world->init();
+        bool ok = true;
+        for (int tick = 0; ok && tick < TICKS_PER_RUN; ++tick) {
+            std::size_t before = allocationCount();
+            int status = world->move();
+            if (allocationCount() != before) {
+                std::printf("run %d tick %d: move() allocated %d times\n", run, tick,
+                            static_cast<int>(allocationCount() - before));
+                ok = false;
+            }
+            if (!continueHeadless(world, status))
+                break;
+        }
+        delete world;
+        return ok;
+    }
+}
+
+int main() {
+    bool ok = true;
+    for (int run = 0; ok && run < RUNS; ++run)
+        ok = playRun(run);
+    std::printf("%s\n", ok ? "AllocationTest passed" : "AllocationTest FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+// Checks DistanceField::repair() against a full compute() on randomised
+// grids: after every batch of walkability changes the repaired field must
+// match a field computed from scratch on the same grid. The same holds when
+// computes and repairs run a slice at a time with the grid changing between
+// slices, as they do under StudentWorld's pathfinding budget, and reads
+// during such a run see the last settled result.
+
+#include "DistanceField.h"
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+    const int SIZE = DistanceField::SIZE;
+
+    std::uint64_t openRows[SIZE];
+    DistanceField repaired;
+    DistanceField fresh;
+    DistanceField previous;
+
+    bool isOpen(int x, int y) {
+        return (openRows[y] >> x) & 1;
+    }
+
+    void setOpen(int x, int y, bool open) {
+        if (open)
+            openRows[y] |= 1ULL << x;
+        else
+            openRows[y] &= ~(1ULL << x);
+    }
+
+    void randomGrid(int openPercent) {
+        for (int y = 0; y < SIZE; ++y) {
+            openRows[y] = 0;
+            for (int x = 0; x < SIZE; ++x)
+                setOpen(x, y, rand() % 100 < openPercent);
+        }
+    }
+
+    // Flips count random positions, reporting each change to field.
+    void toggleRandom(DistanceField& field, int count) {
+        for (int i = 0; i < count; ++i) {
+            int x = rand() % SIZE;
+            int y = rand() % SIZE;
+            setOpen(x, y, !isOpen(x, y));
+            field.markChanged(y, 1ULL << x);
+        }
+    }
+
+    bool sameDistances(const DistanceField& field, const DistanceField& expected) {
+        for (int x = 0; x < SIZE; ++x) {
+            for (int y = 0; y < SIZE; ++y) {
+                if (field.distanceAt(x, y) != expected.distanceAt(x, y)) {
+                    std::printf("  (%d, %d): %d, expected %d\n", x, y,
+                                field.distanceAt(x, y), expected.distanceAt(x, y));
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool matchesFreshCompute(const DistanceField& field) {
+        fresh.compute(openRows, field.getRootX(), field.getRootY());
+        return sameDistances(field, fresh);
+    }
+
+    bool testRepairMatchesCompute() {
+        for (int trial = 0; trial < 300; ++trial) {
+            randomGrid(40 + trial % 50);
+            int rootX = rand() % SIZE;
+            int rootY = rand() % SIZE;
+            setOpen(rootX, rootY, true);
+            repaired.compute(openRows, rootX, rootY);
+            for (int round = 0; round < 20; ++round) {
+                toggleRandom(repaired, 1 + rand() % 40);
+                setOpen(rootX, rootY, true);
+                repaired.repair(openRows);
+                if (!matchesFreshCompute(repaired)) {
+                    std::printf("repair: trial %d round %d differs from a full compute\n", trial, round);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // A position that opens between slices of a compute is first reached
+    // from a farther neighbour; the repair that follows must shorten it.
+    bool testOpenedDuringSlicedCompute() {
+        for (int y = 0; y < SIZE; ++y)
+            openRows[y] = (1ULL << SIZE) - 1;
+        setOpen(1, 0, false);
+        repaired.beginCompute(0, 0);
+        repaired.advance(openRows, 1);
+        setOpen(1, 0, true);
+        repaired.markChanged(0, 1ULL << 1);
+        repaired.advance(openRows, INT_MAX);
+        repaired.beginRepair(openRows);
+        repaired.advance(openRows, INT_MAX);
+        if (repaired.distanceAt(1, 0) != 1) {
+            std::printf("opened during sliced compute: (1, 0) is %d, not 1\n", repaired.distanceAt(1, 0));
+            return false;
+        }
+        return true;
+    }
+
+    // Until a sliced compute or repair settles, reads keep answering from
+    // the last settled result.
+    bool testReadsDuringSlicedRuns() {
+        randomGrid(70);
+        setOpen(0, 0, true);
+        setOpen(SIZE - 1, SIZE - 1, true);
+        repaired.compute(openRows, 0, 0);
+        previous.compute(openRows, 0, 0);
+        if (!repaired.hasResult()) {
+            std::printf("double buffer: no result after compute()\n");
+            return false;
+        }
+
+        repaired.beginCompute(SIZE - 1, SIZE - 1);
+        while (!repaired.isSettled()) {
+            repaired.advance(openRows, 50);
+            if (repaired.isSettled())
+                break;
+            if (repaired.getRootX() != 0 || repaired.getRootY() != 0 || !sameDistances(repaired, previous)) {
+                std::printf("double buffer: a pending compute changed what readers see\n");
+                return false;
+            }
+        }
+        if (repaired.getRootX() != SIZE - 1 || !matchesFreshCompute(repaired)) {
+            std::printf("double buffer: settled compute is not what readers see\n");
+            return false;
+        }
+
+        previous.compute(openRows, SIZE - 1, SIZE - 1);
+        toggleRandom(repaired, 30);
+        setOpen(SIZE - 1, SIZE - 1, true);
+        repaired.beginRepair(openRows);
+        while (!repaired.isSettled()) {
+            repaired.advance(openRows, 5);
+            if (!repaired.isSettled() && !sameDistances(repaired, previous)) {
+                std::printf("double buffer: a pending repair changed what readers see\n");
+                return false;
+            }
+        }
+        if (!matchesFreshCompute(repaired)) {
+            std::printf("double buffer: settled repair is not what readers see\n");
+            return false;
+        }
+
+        repaired.invalidate();
+        if (repaired.hasResult() || repaired.distanceAt(SIZE - 1, SIZE - 1) != DistanceField::UNREACHABLE) {
+            std::printf("double buffer: invalidate() left a result behind\n");
+            return false;
+        }
+        return true;
+    }
+
+    // Drives the field the way StudentWorld::refreshField() does under a
+    // budget, changing the grid between slices, and checks it against a
+    // full compute whenever it settles with nothing left to repair.
+    bool testSlicedMatchesCompute() {
+        for (int trial = 0; trial < 100; ++trial) {
+            randomGrid(40 + trial % 50);
+            int rootX = rand() % SIZE;
+            int rootY = rand() % SIZE;
+            setOpen(rootX, rootY, true);
+            int budget = 1 + rand() % 200;
+            repaired.beginCompute(rootX, rootY);
+            for (int step = 0; step < 400; ++step) {
+                if (rand() % 3 == 0) {
+                    toggleRandom(repaired, 1 + rand() % 8);
+                    setOpen(rootX, rootY, true);
+                }
+                if (repaired.isSettled() && repaired.hasChanges())
+                    repaired.beginRepair(openRows);
+                repaired.advance(openRows, budget);
+                if (repaired.isSettled() && !repaired.hasChanges() && !matchesFreshCompute(repaired)) {
+                    std::printf("sliced: trial %d step %d (budget %d) differs from a full compute\n",
+                                trial, step, budget);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+int main() {
+    srand(1);
+    bool ok = testRepairMatchesCompute() && testOpenedDuringSlicedCompute() &&
+              testReadsDuringSlicedRuns() && testSlicedMatchesCompute();
+    std::printf("%s\n", ok ? "DistanceFieldTest passed" : "DistanceFieldTest FAILED");
+    return ok ? 0 : 1;
+}
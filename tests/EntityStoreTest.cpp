@@ -0,0 +1,68 @@
+// Checks that EntityStore keeps each entry's fields together through
+// removals and that handles to removed entries stop resolving, including
+// when the same object is added again the way pooled actors are.
+
+#include "EntityStore.h"
+#include <cstdio>
+
+namespace {
+    struct Object {
+        int id;
+    };
+
+    bool check(bool condition, const char* what) {
+        if (!condition)
+            std::printf("  %s\n", what);
+        return condition;
+    }
+
+    bool testFieldsSurviveCompaction() {
+        EntityStore<Object> store;
+        Object a = { 1 }, b = { 2 }, c = { 3 };
+        ActorHandle ha = store.add(&a, 1, 2, 5);
+        ActorHandle hb = store.add(&b, 3, 4, 6);
+        ActorHandle hc = store.add(&c, 5, 6, 7);
+        store.setPosition(hc, 7, 8);
+        store.markDead(hb);
+        int released = 0;
+        store.removeDead([&](Object* object) { released += object->id; });
+
+        std::size_t ia = store.positionOf(ha);
+        std::size_t ic = store.positionOf(hc);
+        bool ok = check(released == 2, "removeDead released the wrong objects");
+        ok = check(store.size() == 2, "size after removeDead") && ok;
+        ok = check(store.get(ha) == &a && store.get(hc) == &c, "live handles resolve") && ok;
+        ok = check(ia == 0 && store.xAt(ia) == 1 && store.yAt(ia) == 2 && store.typeAt(ia) == 5,
+                   "first entry's fields") && ok;
+        ok = check(ic == 1 && store.xAt(ic) == 7 && store.yAt(ic) == 8 && store.typeAt(ic) == 7,
+                   "moved entry's fields after compaction") && ok;
+        return ok;
+    }
+
+    bool testStaleHandles() {
+        EntityStore<Object> store;
+        Object pooled = { 1 };
+        ActorHandle first = store.add(&pooled, 0, 0, 1);
+        store.markDead(first);
+        store.removeDead([](Object*) {});
+        bool ok = check(store.get(first) == nullptr, "removed handle still resolves");
+
+        // the pool hands the same object out again
+        ActorHandle second = store.add(&pooled, 0, 0, 1);
+        ok = check(store.get(second) == &pooled, "re-added object resolves") && ok;
+        ok = check(store.get(first) == nullptr, "handle from the object's earlier life resolves") && ok;
+        ok = check(store.positionOf(first) == store.size(), "stale handle has a position") && ok;
+
+        store.clear();
+        ok = check(store.get(second) == nullptr, "handle survives clear()") && ok;
+        ok = check(store.get(NO_ACTOR) == nullptr, "NO_ACTOR resolves") && ok;
+        return ok;
+    }
+}
+
+int main() {
+    bool ok = testFieldsSurviveCompaction();
+    ok = testStaleHandles() && ok;
+    std::printf("%s\n", ok ? "EntityStoreTest passed" : "EntityStoreTest FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+// Stands in for GameController so the game logic can run without a window:
+// keys come from a fixed pseudo-random script, and sounds and the status
+// line are discarded.
+
+#include "GameWorld.h"
+#include <string>
+
+namespace {
+    unsigned long long keyState = 88172645463325252ULL;
+
+    unsigned nextRandom() {
+        keyState ^= keyState << 13;
+        keyState ^= keyState >> 7;
+        keyState ^= keyState << 17;
+        return static_cast<unsigned>(keyState);
+    }
+}
+
+// Restarts the key script; the same seed always yields the same keys.
+void seedHeadlessKeys(unsigned seed) {
+    keyState = 88172645463325252ULL ^ (seed * 2654435761ULL);
+}
+
+bool GameWorld::getKey(int& value) {
+    unsigned r = nextRandom() % 100;
+    if (r < 30)
+        return false;
+    static const int moves[] = { KEY_PRESS_LEFT, KEY_PRESS_RIGHT, KEY_PRESS_UP, KEY_PRESS_DOWN };
+    if (r < 90)
+        value = moves[nextRandom() % 4];
+    else if (r < 95)
+        value = KEY_PRESS_SPACE;
+    else if (r < 97)
+        value = 'z';
+    else
+        value = KEY_PRESS_TAB;
+    return true;
+}
+
+void GameWorld::playSound(int) {
+}
+
+void GameWorld::setGameStatText(const std::string&) {
+}
+
+// Does what GameController does after move() returns status: a finished
+// level advances, and a lost life or finished level restarts the level
+// unless the game is over. move() has already taken the life. Returns
+// false once the game is over.
+bool continueHeadless(GameWorld* world, int status) {
+    if (status == GWSTATUS_CONTINUE_GAME)
+        return true;
+    if (status == GWSTATUS_PLAYER_DIED && world->isGameOver())
+        return false;
+    if (status == GWSTATUS_FINISHED_LEVEL)
+        world->advanceToNextLevel();
+    world->cleanUp();
+    world->init();
+    return true;
+}
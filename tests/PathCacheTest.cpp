@@ -0,0 +1,206 @@
+// Checks that a PathCache route only replays while it is still the route a
+// protester would take: terrain changes are tracked per region the way
+// StudentWorld does it, and every step the cache hands out, and every
+// step count it reports, must match a field freshly computed on the grid
+// as it is at that moment.
+
+#include "PathCache.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+    const int SIZE = DistanceField::SIZE;
+    typedef GraphObject::Direction Direction;
+
+    std::uint64_t openRows[SIZE];
+    // as in StudentWorld: bumped by every change, and the version of the
+    // last change in each region
+    std::uint32_t terrainVersion;
+    std::uint32_t regionChangedAt[64];
+    DistanceField field;
+    DistanceField fresh;
+    PathCache path;
+
+    bool isOpen(int x, int y) {
+        return (openRows[y] >> x) & 1;
+    }
+
+    void setOpen(int x, int y, bool open) {
+        if (isOpen(x, y) == open)
+            return;
+        openRows[y] ^= 1ULL << x;
+        terrainVersion++;
+        regionChangedAt[PathCache::regionOf(x, y)] = terrainVersion;
+    }
+
+    void clearGrid() {
+        for (int y = 0; y < SIZE; ++y)
+            openRows[y] = 0;
+        terrainVersion++;
+        for (int r = 0; r < 64; ++r)
+            regionChangedAt[r] = terrainVersion;
+    }
+
+    void openSpan(int x1, int y1, int x2, int y2) {
+        for (int x = x1; x <= x2; ++x) {
+            for (int y = y1; y <= y2; ++y)
+                setOpen(x, y, true);
+        }
+    }
+
+    bool isUnchanged() {
+        std::uint64_t regions = path.getRegions();
+        for (int r = 0; regions != 0; ++r, regions >>= 1) {
+            if ((regions & 1) && regionChangedAt[r] > path.getVersion())
+                return false;
+        }
+        return true;
+    }
+
+    // the step Protester::directionDownhill() picks
+    Direction downhill(const DistanceField& f, int x, int y) {
+        int dist = f.distanceAt(x, y);
+        if (dist > 0) {
+            if (f.distanceAt(x - 1, y) == dist - 1) return GraphObject::left;
+            if (f.distanceAt(x + 1, y) == dist - 1) return GraphObject::right;
+            if (f.distanceAt(x, y - 1) == dist - 1) return GraphObject::down;
+            if (f.distanceAt(x, y + 1) == dist - 1) return GraphObject::up;
+        }
+        return GraphObject::left;
+    }
+
+    void stepFrom(int& x, int& y, Direction dir) {
+        switch (dir) {
+            case GraphObject::left: x--; break;
+            case GraphObject::right: x++; break;
+            case GraphObject::down: y--; break;
+            case GraphObject::up: y++; break;
+            default: break;
+        }
+    }
+
+    // Replays path from (x, y) towards (rootX, rootY) as long as it holds,
+    // checking each step against a fresh field. Returns false on the first
+    // step that differs; steps counts the steps replayed.
+    bool replayMatchesFresh(int x, int y, int rootX, int rootY, int& steps) {
+        steps = 0;
+        Direction dir;
+        while (isUnchanged() && path.nextStep(x, y, rootX, rootY, dir)) {
+            fresh.compute(openRows, rootX, rootY);
+            int left = path.stepsLeft(x, y, rootX, rootY);
+            if (dir != downhill(fresh, x, y) || (left >= 0 && left != fresh.distanceAt(x, y))) {
+                std::printf("  at (%d, %d): cached step %d with %d left, fresh step %d with %d left\n",
+                            x, y, dir, left, downhill(fresh, x, y), fresh.distanceAt(x, y));
+                return false;
+            }
+            path.advance();
+            stepFrom(x, y, dir);
+            ++steps;
+        }
+        return true;
+    }
+
+    // A dig far from the route's first steps joins two tunnels and opens a
+    // shortcut; the route must not outlive it. Then a change right on the
+    // route must end it too.
+    bool testShortcutAndBlockedRoute() {
+        clearGrid();
+        // the long way round: along the bottom, up the right side and back
+        // along the top to (0, 60)
+        openSpan(0, 0, 60, 0);
+        openSpan(60, 0, 60, 60);
+        openSpan(0, 60, 60, 60);
+        // dead ends up from the start and down from the root
+        openSpan(0, 0, 0, 40);
+        openSpan(0, 42, 0, 60);
+        field.compute(openRows, 0, 60);
+        path.record(field, 0, 0, terrainVersion);
+
+        setOpen(0, 41, true);
+        int steps;
+        if (!replayMatchesFresh(0, 0, 0, 60, steps)) {
+            std::printf("shortcut: the route outlived a dig that shortens it\n");
+            return false;
+        }
+
+        field.compute(openRows, 0, 60);
+        path.record(field, 0, 0, terrainVersion);
+        setOpen(0, 20, false);
+        if (isUnchanged()) {
+            std::printf("blocked: closing a position on the route left it standing\n");
+            return false;
+        }
+        return true;
+    }
+
+    // A straight route has no room for a detour, so a change well away
+    // from it leaves the whole route to replay.
+    bool testChangeAwayFromRoute() {
+        clearGrid();
+        openSpan(0, 0, 20, 0);
+        openSpan(40, 40, 60, 60);
+        field.compute(openRows, 20, 0);
+        path.record(field, 0, 0, terrainVersion);
+        setOpen(50, 30, true);
+        int steps;
+        if (!replayMatchesFresh(0, 0, 20, 0, steps))
+            return false;
+        if (steps != 20) {
+            std::printf("away: %d of 20 steps replayed after an unrelated change\n", steps);
+            return false;
+        }
+        return true;
+    }
+
+    // Random grids with random digs and collapses between steps, routes
+    // recorded again whenever they stop holding, as Protester::followPath()
+    // does.
+    bool testRandomChanges() {
+        int replayed = 0;
+        for (int trial = 0; trial < 200; ++trial) {
+            clearGrid();
+            for (int y = 0; y < SIZE; ++y) {
+                for (int x = 0; x < SIZE; ++x)
+                    setOpen(x, y, rand() % 100 < 55 + trial % 40);
+            }
+            int rootX = trial % 2 ? 60 : rand() % SIZE;
+            int rootY = trial % 2 ? 60 : rand() % SIZE;
+            int x = rand() % SIZE;
+            int y = rand() % SIZE;
+            setOpen(rootX, rootY, true);
+            for (int round = 0; round < 30; ++round) {
+                field.compute(openRows, rootX, rootY);
+                if (field.distanceAt(x, y) <= 0)
+                    break;
+                path.record(field, x, y, terrainVersion);
+                int changes = 1 + rand() % 3;
+                for (int i = 0; i < changes; ++i)
+                    setOpen(rand() % SIZE, rand() % SIZE, rand() % 2 == 0);
+                setOpen(rootX, rootY, true);
+                int steps;
+                if (!replayMatchesFresh(x, y, rootX, rootY, steps)) {
+                    std::printf("random: trial %d round %d replayed a stale step\n", trial, round);
+                    return false;
+                }
+                replayed += steps;
+                // walk on the way a protester would before recording again
+                fresh.compute(openRows, rootX, rootY);
+                for (int i = 0; i < 5 && fresh.distanceAt(x, y) > 0; ++i)
+                    stepFrom(x, y, downhill(fresh, x, y));
+            }
+        }
+        if (replayed == 0) {
+            std::printf("random: no route outlived a change\n");
+            return false;
+        }
+        return true;
+    }
+}
+
+int main() {
+    srand(1);
+    bool ok = testShortcutAndBlockedRoute() && testChangeAwayFromRoute() && testRandomChanges();
+    std::printf("%s\n", ok ? "PathCacheTest passed" : "PathCacheTest FAILED");
+    return ok ? 0 : 1;
+}
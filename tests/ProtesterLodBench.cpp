@@ -0,0 +1,62 @@
+// Times move() at high protester counts for several protester detail
+// radii. Every run starts on a level between 10 and 15, where up to 15
+// protesters are on the field at once, and plays until the game is over.
+//
+//     make bench
+//     ./ProtesterLodBench [runs] [repetitions]
+
+#include "GameConstants.h"
+#include "StudentWorld.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+GameWorld* createStudentWorld(std::string assetDir);
+void seedHeadlessKeys(unsigned seed);
+bool continueHeadless(GameWorld* world, int status);
+
+namespace {
+    const int TICKS_PER_RUN = 3000;
+
+    // Returns the microseconds spent in move() per tick.
+    double timeRuns(double radius, int runs) {
+        double seconds = 0;
+        long ticks = 0;
+        for (int run = 0; run < runs; ++run) {
+            srand(run + 1);
+            seedHeadlessKeys(run + 1);
+            StudentWorld* world = static_cast<StudentWorld*>(createStudentWorld(""));
+            world->setProtesterDetailRadius(radius);
+            for (int level = 0; level < 10 + run % 6; ++level)
+                world->advanceToNextLevel();
+            world->init();
+            for (int tick = 0; tick < TICKS_PER_RUN; ++tick) {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                int status = world->move();
+                seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                ++ticks;
+                if (!continueHeadless(world, status))
+                    break;
+            }
+            delete world;
+        }
+        return seconds * 1e6 / ticks;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int runs = argc > 1 ? std::atoi(argv[1]) : 20;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+    const double radii[] = { 0, 24, 16, 8 };
+    for (double radius : radii) {
+        std::vector<double> times;
+        for (int i = 0; i < repetitions; ++i)
+            times.push_back(timeRuns(radius, runs));
+        std::sort(times.begin(), times.end());
+        std::printf("radius %4.1f%s  min %6.3f  median %6.3f us/tick\n", radius, radius == 0 ? " (off)" : "      ",
+                    times.front(), times[times.size() / 2]);
+    }
+    return 0;
+}
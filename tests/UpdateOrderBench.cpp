@@ -0,0 +1,56 @@
+// Times the same scripted games under both update orders. Each run starts
+// on a later level than the last, so the later runs have more protesters
+// and pickups on the field.
+//
+//     make bench
+//     ./UpdateOrderBench [runs]
+
+#include "GameConstants.h"
+#include "StudentWorld.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+GameWorld* createStudentWorld(std::string assetDir);
+void seedHeadlessKeys(unsigned seed);
+bool continueHeadless(GameWorld* world, int status);
+
+namespace {
+    const int TICKS_PER_RUN = 3000;
+
+    // Returns the number of ticks played.
+    long playRuns(StudentWorld::UpdateOrder order, int runs) {
+        long ticks = 0;
+        for (int run = 0; run < runs; ++run) {
+            srand(run + 1);
+            seedHeadlessKeys(run + 1);
+            StudentWorld* world = static_cast<StudentWorld*>(createStudentWorld(""));
+            world->setUpdateOrder(order);
+            for (int level = 0; level < run % 8; ++level)
+                world->advanceToNextLevel();
+            world->init();
+            for (int tick = 0; tick < TICKS_PER_RUN; ++tick) {
+                int status = world->move();
+                ++ticks;
+                if (!continueHeadless(world, status))
+                    break;
+            }
+            delete world;
+        }
+        return ticks;
+    }
+
+    void timeOrder(const char* name, StudentWorld::UpdateOrder order, int runs) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        long ticks = playRuns(order, runs);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-12s %8ld ticks %9.1f ms %7.3f us/tick\n", name, ticks, ms, ms * 1000.0 / ticks);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int runs = argc > 1 ? std::atoi(argv[1]) : 40;
+    timeOrder("interleaved", StudentWorld::UPDATE_INTERLEAVED, runs);
+    timeOrder("by type", StudentWorld::UPDATE_BY_TYPE, runs);
+    return 0;
+}